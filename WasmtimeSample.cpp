@@ -1,34 +1,76 @@
 // WasmtimeSample.cpp
 #include <iostream>
-#include <fstream>
-#include <vector>
 #include <string>
 
 // 引入核心封装
-#include "WasmtimeCore.h"
-
-// 辅助函数：读取二进制文件
-std::vector<uint8_t> readFile(const std::string& path) {
-    std::ifstream file(path, std::ios::binary | std::ios::ate);
-    if (!file.is_open()) {
-        std::cerr << "Failed to open file: " << path << std::endl;
-        return {};
+#include "WasmConfig.h"
+#include "WasmModule.h"
+#include "WasmEpochTicker.h"
+#include "JniUtils.h"
+
+// 辅助函数：打印 Wasmtime 错误 / Trap
+static void printError(const char* stage, wasmtime_error_t* err, wasm_trap_t* trap) {
+    wasm_byte_vec_t msg;
+    if (err) {
+        wasmtime_error_message(err, &msg);
+        wasmtime_error_delete(err);
+    } else {
+        wasm_trap_message(trap, &msg);
+        wasm_trap_delete(trap);
     }
+    std::cerr << stage << " failed: " << std::string(msg.data, msg.size) << std::endl;
+    wasm_byte_vec_delete(&msg);
+}
 
-    std::streamsize size = file.tellg();
-    file.seekg(0, std::ios::beg);
+// 直接调用导出函数 add(a, b)，失败返回 -1
+static int32_t runAddFunction(WasmModule* module, int32_t a, int32_t b) {
+    if (!module->getInstancePre()) return -1;
 
-    std::vector<uint8_t> buffer(size);
-    if (!file.read((char*)buffer.data(), size)) {
-        std::cerr << "Failed to read file content" << std::endl;
-        return {};
+    wasmtime_store_t* store = wasmtime_store_new(module->getEngine(), nullptr, nullptr);
+    wasmtime_context_t* context = wasmtime_store_context(store);
+
+    // 桌面端直接继承宿主的标准输出
+    wasi_config_t* wasi = wasi_config_new();
+    wasi_config_inherit_stdout(wasi);
+    wasi_config_inherit_stderr(wasi);
+    wasmtime_context_set_wasi(context, wasi);
+
+    // 启用 epoch 中断的 Engine 上，Store 默认截止值为 0，必须显式放开
+    if (module->hasEpochInterruption()) {
+        wasmtime_context_set_epoch_deadline(context, WasmEpochTicker::kNoDeadline);
+    }
+
+    int32_t result = -1;
+    wasmtime_instance_t instance;
+    wasm_trap_t* trap = nullptr;
+    wasmtime_error_t* err = wasmtime_instance_pre_instantiate(module->getInstancePre(), context, &instance, &trap);
+    if (err || trap) {
+        printError("Instantiate", err, trap);
+        wasmtime_store_delete(store);
+        return -1;
+    }
+
+    // Kotlin/Wasm 运行时初始化
+    wasmtime_extern_t item;
+    if (wasmtime_instance_export_get(context, &instance, "_initialize", 11, &item) && item.kind == WASMTIME_EXTERN_FUNC) {
+        err = wasmtime_func_call(context, &item.of.func, nullptr, 0, nullptr, 0, &trap);
+        if (err || trap) printError("_initialize", err, trap);
+    }
+
+    if (wasmtime_instance_export_get(context, &instance, "add", 3, &item) && item.kind == WASMTIME_EXTERN_FUNC) {
+        wasmtime_val_t args[2];
+        args[0].kind = WASMTIME_I32; args[0].of.i32 = a;
+        args[1].kind = WASMTIME_I32; args[1].of.i32 = b;
+        wasmtime_val_t ret;
+        err = wasmtime_func_call(context, &item.of.func, args, 2, &ret, 1, &trap);
+        if (err || trap) printError("add", err, trap);
+        else result = ret.of.i32;
+    } else {
+        std::cerr << "Export add not found" << std::endl;
     }
-    return buffer;
-}
 
-// macOS 本地日志回调
-void console_logger(const std::string& msg) {
-    std::cout << "[MacOS-Native] " << msg << std::endl;
+    wasmtime_store_delete(store);
+    return result;
 }
 
 int main(int argc, char** argv) {
@@ -39,40 +81,34 @@ int main(int argc, char** argv) {
         wasmPath = argv[1];
     }
 
-    std::cout << "Loading Wasm from: " << wasmPath << std::endl;
-
-    // 2. 读取文件
-    std::vector<uint8_t> wasmBytes = readFile(wasmPath);
-    if (wasmBytes.empty()) {
+    // 2. 配置 Wasmtime (桌面端默认 linux-server-fast，可通过第二个参数切换 Profile)
+    // Kotlin/Wasm 必须项 (GC / 异常处理 / 函数引用) 在所有 Profile 中都是开启的
+    WasmConfig config = WasmConfig::linuxServerFast();
+    if (argc > 2 && !WasmConfig::fromName(argv[2], config)) {
+        std::cerr << "Unknown profile: " << argv[2] << std::endl;
         return 1;
     }
 
-    // 3. 配置 Wasmtime (针对 macOS 环境)
-    WasmConfig config;
-    
-    // --- Kotlin/Wasm 必须项 (保持 True) ---
-    config.enableGc = true;
-    config.enableExceptionHandling = true;
-    config.enableFunctionReferences = true;
+    std::cout << "Loading Wasm from: " << wasmPath << " with " << config.describe() << std::endl;
 
-    // --- macOS 性能优化项 (与 Android 不同，这里建议开启) ---
-    config.enableSimd = true;              // M1/M2 支持 SIMD
-    config.enableSignalsBasedTraps = true; // 桌面端可以使用信号捕获 Trap
-    config.enableCraneliftOpt = true;      // 开启 JIT 全速优化
-
-    // 日志
-    config.enableWasiOutput = true;
-
-    // 4. 实例化 Core
-    WasmtimeCore core(config);
-    core.setLogCallback(console_logger);
+    // 3. 读取并编译
+    std::vector<uint8_t> wasmBytes = JniUtils::readFile(wasmPath);
+    if (wasmBytes.empty()) {
+        std::cerr << "Failed to read file: " << wasmPath << std::endl;
+        return 1;
+    }
+    WasmModule* module = WasmModule::loadFromSource(wasmBytes, config);
+    if (!module) {
+        std::cerr << "Compile Failed." << std::endl;
+        return 1;
+    }
 
-    // 5. 运行 add 函数 (例如 11 + 22)
+    // 4. 运行 add 函数 (例如 55 + 22)
     int a = 55;
     int b = 22;
     std::cout << "Calling add(" << a << ", " << b << ")..." << std::endl;
-    
-    int32_t result = core.runAddFunction(wasmBytes, a, b);
+
+    int32_t result = runAddFunction(module, a, b);
 
     if (result != -1) {
         std::cout << "Computation Finished. Result = " << result << std::endl;
@@ -80,5 +116,6 @@ int main(int argc, char** argv) {
         std::cerr << "Computation Failed." << std::endl;
     }
 
+    delete module;
     return 0;
-}
\ No newline at end of file
+}
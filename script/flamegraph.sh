@@ -0,0 +1,73 @@
+#!/bin/bash
+
+# ==========================================
+# Linux 火焰图: 采样 wasmline_bench，并把 Cranelift 生成的 Guest 代码符号化
+#
+# perfmap: Wasmtime 写 /tmp/perf-<pid>.map，perf report / perf script 直接解析，最简单
+# jitdump: Wasmtime 写 ./jit-<pid>.dump，需 perf record -k mono + perf inject --jit，可带行号信息
+# 两种方式都会注册 JIT 编译与 loadFromPath (.cwasm 反序列化) 得到的代码，bench 中 "synthetic.cwasm" 一项即 AOT 路径。
+# 函数名来自 Wasm name section，编译插件时不要剥离 (Kotlin/Wasm 默认保留)。
+#
+# 依赖: perf，以及 FlameGraph (stackcollapse-perf.pl / flamegraph.pl) 或 inferno
+# 用法: script/flamegraph.sh [perfmap|jitdump] [bench 参数...]
+# ==========================================
+
+# Exit on any error
+set -e
+
+# Import environment variables
+if [ "$ENV_SOURCED_MARKER" != "true" ]; then
+    source "$(dirname "${BASH_SOURCE[0]}")/env.sh"
+fi
+
+echo "[shell flamegraph.sh] --> -----------------------------"
+
+MODE="${1:-perfmap}"
+shift || true
+BENCH_ARGS="${*:---iterations 2000 --payload 1024 --threads 1}"
+BENCH="$BUILD_DIR/wasmline_bench"
+OUT_DIR="$BUILD_DIR/flamegraph"
+
+if ! command -v perf > /dev/null; then
+    echo "Error: perf not found (linux-tools)"
+    exit 1
+fi
+
+# 1. 构建 bench (带帧指针 / 调试信息，便于 Host 侧栈回溯)
+cmake -S . -B "$BUILD_DIR" -DCMAKE_BUILD_TYPE=RelWithDebInfo
+cmake --build "$BUILD_DIR" --target wasmline_bench -j"$(nproc)"
+mkdir -p "$OUT_DIR"
+cd "$OUT_DIR"
+
+# 2. 采样 (WASMLINE_PROFILER 让 Engine 在创建时打开对应的 Profiler)
+echo "[shell flamegraph.sh] --> Recording ($MODE): $BENCH $BENCH_ARGS"
+case "$MODE" in
+    perfmap)
+        WASMLINE_PROFILER=perfmap perf record -F 999 -g -o perf.data "$BENCH" $BENCH_ARGS --out bench.json
+        PERF_DATA=perf.data
+        ;;
+    jitdump)
+        # -k mono: jitdump 的时间戳基于 CLOCK_MONOTONIC
+        WASMLINE_PROFILER=jitdump perf record -k mono -F 999 -g -o perf.data "$BENCH" $BENCH_ARGS --out bench.json
+        # 把 jit-<pid>.dump 中的代码拆成 .so 并合并进采样数据
+        perf inject --jit -i perf.data -o perf.jit.data
+        PERF_DATA=perf.jit.data
+        ;;
+    *)
+        echo "Usage: $0 [perfmap|jitdump] [bench args...]"
+        exit 1
+        ;;
+esac
+
+# 3. 折叠调用栈并生成 SVG
+perf script -i "$PERF_DATA" > perf.stacks
+if command -v inferno-collapse-perf > /dev/null; then
+    inferno-collapse-perf < perf.stacks | inferno-flamegraph > flamegraph.svg
+elif command -v stackcollapse-perf.pl > /dev/null; then
+    stackcollapse-perf.pl perf.stacks | flamegraph.pl > flamegraph.svg
+else
+    echo "Warning: FlameGraph / inferno not found, only $OUT_DIR/perf.stacks was produced"
+    exit 0
+fi
+
+echo "[shell flamegraph.sh] --> Done: $OUT_DIR/flamegraph.svg"
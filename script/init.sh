@@ -111,6 +111,10 @@ for url in $DOWNLOAD_URLS; do
     elif [[ "$filename" == *"aarch64-linux-c-api"* ]]; then
         process_single_task "$url" "$filename" "linux/aarch64"
 
+    # 2.1 Linux (x86_64)，目录名与 CMAKE_SYSTEM_PROCESSOR 一致
+    elif [[ "$filename" == *"x86_64-linux-c-api"* ]]; then
+        process_single_task "$url" "$filename" "linux/x86_64"
+
     # 3. macOS (aarch64)
     elif [[ "$filename" == *"aarch64-macos-c-api"* ]]; then
         process_single_task "$url" "$filename" "mac/aarch64"
@@ -0,0 +1,64 @@
+#!/bin/bash
+
+# ==========================================
+# Wasm 预初始化 (Wizer 快照)
+#
+# 离线执行一次初始化函数，把初始化后的线性内存 / 全局变量固化进新的 .wasm，
+# 运行时 WasmExecutor 发现模块不再导出 _initialize (或带有 __wasmline_preinitialized 标记) 时直接跳过初始化。
+#
+# 限制: Wizer 只能快照线性内存与全局变量，不支持 Wasm GC 堆。
+# Kotlin/Wasm 的运行时与路由表都分配在 GC 堆上，因此 Kotlin/Wasm 插件不能用此脚本预初始化；
+# 适用于 C / Rust / TinyGo 等只使用线性内存的模块。
+#
+# 用法: script/preinit.sh <input.wasm> <output.wasm> [init-func] [--cwasm <output.cwasm>]
+# ==========================================
+
+# Exit on any error
+set -e
+
+# Import environment variables
+if [ "$ENV_SOURCED_MARKER" != "true" ]; then
+    source "$(dirname "${BASH_SOURCE[0]}")/env.sh"
+fi
+
+echo "[shell preinit.sh] --> -----------------------------"
+
+INPUT="$1"
+OUTPUT="$2"
+INIT_FUNC="${3:-_initialize}"
+CWASM=""
+if [ "$4" == "--cwasm" ]; then
+    CWASM="$5"
+fi
+
+if [ -z "$INPUT" ] || [ -z "$OUTPUT" ]; then
+    echo "Usage: $0 <input.wasm> <output.wasm> [init-func] [--cwasm <output.cwasm>]"
+    exit 1
+fi
+
+if ! command -v wizer > /dev/null; then
+    echo "Error: wizer not found. Install with: cargo install wizer --all-features"
+    exit 1
+fi
+
+# Wizer 遇到 GC 类型会直接校验失败，这里提前给出更明确的提示
+if command -v wasm-tools > /dev/null && wasm-tools print "$INPUT" | grep -qE "\((rec|struct|array) "; then
+    echo "Error: $INPUT uses Wasm GC types (e.g. Kotlin/Wasm), Wizer cannot snapshot the GC heap."
+    exit 1
+fi
+
+# 1. 执行初始化函数并生成快照 (Wizer 会从输出中移除初始化函数的导出)
+echo "[shell preinit.sh] --> Snapshotting $INPUT (init-func: $INIT_FUNC)"
+wizer "$INPUT" -o "$OUTPUT" --init-func "$INIT_FUNC" --allow-wasi --wasm-bulk-memory true
+
+# 2. 可选: 直接 AOT 编译为 .cwasm (参数需与运行时的 WasmConfig Profile 保持一致)
+if [ -n "$CWASM" ]; then
+    if ! command -v wasmtime > /dev/null; then
+        echo "Error: wasmtime CLI not found, cannot produce $CWASM"
+        exit 1
+    fi
+    echo "[shell preinit.sh] --> Compiling $OUTPUT -> $CWASM"
+    wasmtime compile "$OUTPUT" -o "$CWASM"
+fi
+
+echo "[shell preinit.sh] --> Done: $OUTPUT"
@@ -0,0 +1,471 @@
+// WasmlineBench.cpp
+// 全生命周期基准测试: 分别测量 Engine 创建、JIT 编译、序列化、反序列化 (整读 / mmap)、
+// Store 创建、实例化、_initialize、run_entry，以及并发压测、批量调用与 epoch 中断的开销，结果输出为 JSON。
+//
+// 用法: wasmline_bench [--iterations N] [--payload 16,1024,65536] [--threads T] [--batch B]
+//                      [--profile android-safe|android-interruptible|linux-server-fast|fast-startup]
+//                      [--wasm wasm/add.wasm] [--out result.json]
+//                      [--profiler none|perfmap|jitdump|vtune]
+//
+// 火焰图: 以 --profiler perfmap (或 jitdump) 运行并用 perf record 采样，Guest 函数即可被符号化，
+// 其中 "synthetic.cwasm" 一项走 saveCacheToPath + loadFromPath，覆盖 AOT 缓存加载的场景。完整流程见 script/flamegraph.sh。
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <unistd.h>
+
+#include "WasmConfig.h"
+#include "WasmEngineRegistry.h"
+#include "WasmEpochTicker.h"
+#include "WasmExecutor.h"
+#include "WasmModule.h"
+#include "WasmModuleCache.h"
+#include "JniUtils.h"
+
+// 合成的 Kotlin 风格插件: 与 Kotlin/Wasm SDK 相同的 Host ABI，
+// _initialize 模拟运行时启动 + 路由注册 (填充 64KiB 表)，run_entry 读入 action / json 后原样回写 json
+static const char* kSyntheticPluginWat = R"WAT(
+(module
+  (import "env" "host_get_action_size" (func $action_size (result i32)))
+  (import "env" "host_get_json_size" (func $json_size (result i32)))
+  (import "env" "host_read_input" (func $read (param i32 i32 i32) (result i32)))
+  (import "env" "host_write_result" (func $write (param i32 i32)))
+  (memory (export "memory") 64)
+  (global $ready (mut i32) (i32.const 0))
+  (func (export "_initialize")
+    (local $i i32)
+    (loop $fill
+      (i32.store (local.get $i) (i32.mul (local.get $i) (i32.const 0x9E3779B1)))
+      (local.set $i (i32.add (local.get $i) (i32.const 4)))
+      (br_if $fill (i32.lt_u (local.get $i) (i32.const 65536))))
+    (global.set $ready (i32.const 1)))
+  (func (export "run_entry")
+    (local $a i32) (local $j i32)
+    (local.set $a (call $action_size))
+    (local.set $j (call $json_size))
+    (drop (call $read (i32.const 0) (i32.const 65536) (local.get $a)))
+    (drop (call $read (i32.const 1) (i32.const 131072) (local.get $j)))
+    (call $write (i32.const 131072) (local.get $j)))
+)
+)WAT";
+
+// 合成插件线性内存 4MiB，json 从 128KiB 处开始
+static constexpr size_t kMaxPayload = 4 * 1024 * 1024 - 131072;
+
+struct Options {
+    int iterations = 50;
+    std::vector<size_t> payloads = {16, 1024, 65536};
+    int threads = 0;
+    int batch = 100;
+    std::string profile = "default";
+    std::string wasmPath = "wasm/add.wasm";
+    std::string outPath;
+    std::string profiler; // 为空时沿用 Profile 设置 (以及 WASMLINE_PROFILER 环境变量)
+};
+
+using Clock = std::chrono::steady_clock;
+
+static double elapsedNs(Clock::time_point start) {
+    return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+}
+
+// --- 统计与 JSON 输出 ---
+
+class Report {
+public:
+    // 记录一个阶段的样本 (纳秒)，输出 mean / p50 / p99 (微秒)
+    void phase(const std::string& module, const std::string& name, std::vector<double> samples) {
+        if (samples.empty()) return;
+        std::sort(samples.begin(), samples.end());
+        double sum = 0;
+        for (double s : samples) sum += s;
+        auto pct = [&](double p) { return samples[std::min(samples.size() - 1, (size_t)(p * (samples.size() - 1) + 0.5))]; };
+
+        std::ostringstream os;
+        os << "{\"module\": \"" << module << "\", \"phase\": \"" << name << "\", \"samples\": " << samples.size()
+           << ", \"mean_us\": " << sum / samples.size() / 1000.0
+           << ", \"p50_us\": " << pct(0.50) / 1000.0
+           << ", \"p99_us\": " << pct(0.99) / 1000.0 << "}";
+        entries.push_back(os.str());
+        std::cerr << "[bench] " << module << " / " << name << ": mean=" << sum / samples.size() / 1000.0
+                  << "us p50=" << pct(0.50) / 1000.0 << "us p99=" << pct(0.99) / 1000.0 << "us" << std::endl;
+    }
+
+    // 场景级汇总 (如吞吐量)
+    void scenario(const std::string& json) { scenarios.push_back(json); }
+
+    std::string toJson(const Options& opt, const WasmConfig& config) const {
+        std::ostringstream os;
+        os << "{\n  \"config\": \"" << config.describe() << "\",\n  \"iterations\": " << opt.iterations
+           << ",\n  \"phases\": [\n";
+        for (size_t i = 0; i < entries.size(); ++i) os << "    " << entries[i] << (i + 1 < entries.size() ? ",\n" : "\n");
+        os << "  ],\n  \"scenarios\": [\n";
+        for (size_t i = 0; i < scenarios.size(); ++i) os << "    " << scenarios[i] << (i + 1 < scenarios.size() ? ",\n" : "\n");
+        os << "  ]\n}\n";
+        return os.str();
+    }
+
+private:
+    std::vector<std::string> entries;
+    std::vector<std::string> scenarios;
+};
+
+static bool check(const char* stage, wasmtime_error_t* err, wasm_trap_t* trap = nullptr) {
+    if (!err && !trap) return true;
+    wasm_byte_vec_t msg;
+    if (err) wasmtime_error_message(err, &msg);
+    else wasm_trap_message(trap, &msg);
+    std::cerr << "[bench] " << stage << " failed: " << std::string(msg.data, msg.size) << std::endl;
+    wasm_byte_vec_delete(&msg);
+    if (err) wasmtime_error_delete(err);
+    if (trap) wasm_trap_delete(trap);
+    return false;
+}
+
+// --- 各阶段 ---
+
+static void benchEngineCreate(Report& report, const Options& opt, const WasmConfig& config) {
+    std::vector<double> samples;
+    for (int i = 0; i < opt.iterations; ++i) {
+        auto start = Clock::now();
+        wasm_engine_t* engine = wasm_engine_new_with_config(config.build());
+        samples.push_back(elapsedNs(start));
+        wasm_engine_delete(engine);
+    }
+    report.phase("-", "engine_create", samples);
+}
+
+// JIT 编译、序列化、反序列化 (整读 / mmap)
+static void benchCompile(Report& report, const Options& opt, wasm_engine_t* engine,
+                         const std::string& name, const std::vector<uint8_t>& wasm) {
+    std::vector<double> compile, serialize, buffered, mapped;
+    std::string cachePath = "/tmp/wasmline_bench_" + std::to_string(getpid()) + ".cwasm";
+
+    for (int i = 0; i < opt.iterations; ++i) {
+        wasmtime_module_t* module = nullptr;
+        auto start = Clock::now();
+        if (!check("compile", wasmtime_module_new(engine, wasm.data(), wasm.size(), &module))) return;
+        compile.push_back(elapsedNs(start));
+
+        wasm_byte_vec_t bytes;
+        start = Clock::now();
+        if (!check("serialize", wasmtime_module_serialize(module, &bytes))) return;
+        serialize.push_back(elapsedNs(start));
+        wasmtime_module_delete(module);
+
+        start = Clock::now();
+        if (!check("deserialize", wasmtime_module_deserialize(engine, (const uint8_t*)bytes.data, bytes.size, &module))) return;
+        buffered.push_back(elapsedNs(start));
+        wasmtime_module_delete(module);
+
+        JniUtils::writeFileAtomic(cachePath, (const uint8_t*)bytes.data, bytes.size);
+        wasm_byte_vec_delete(&bytes);
+        start = Clock::now();
+        if (!check("deserialize_file", wasmtime_module_deserialize_file(engine, cachePath.c_str(), &module))) return;
+        mapped.push_back(elapsedNs(start));
+        wasmtime_module_delete(module);
+    }
+    unlink(cachePath.c_str());
+
+    report.phase(name, "jit_compile", compile);
+    report.phase(name, "serialize", serialize);
+    report.phase(name, "deserialize_buffered", buffered);
+    report.phase(name, "deserialize_mmap", mapped);
+}
+
+// Store 创建、实例化、_initialize (直接走 C API，分别计时)
+static void benchInstantiate(Report& report, const Options& opt, WasmModule* module, const std::string& name) {
+    if (!module->getInstancePre()) {
+        std::cerr << "[bench] " << name << ": unresolved imports, skip instantiate" << std::endl;
+        return;
+    }
+    std::vector<double> storeCreate, instantiate, initialize, storeDrop;
+    for (int i = 0; i < opt.iterations; ++i) {
+        auto start = Clock::now();
+        wasmtime_store_t* store = wasmtime_store_new(module->getEngine(), nullptr, nullptr);
+        wasmtime_context_t* context = wasmtime_store_context(store);
+        wasmtime_context_set_wasi(context, wasi_config_new());
+        if (module->hasEpochInterruption()) wasmtime_context_set_epoch_deadline(context, WasmEpochTicker::kNoDeadline);
+        storeCreate.push_back(elapsedNs(start));
+
+        wasmtime_instance_t instance;
+        wasm_trap_t* trap = nullptr;
+        start = Clock::now();
+        bool ok = check("instantiate", wasmtime_instance_pre_instantiate(module->getInstancePre(), context, &instance, &trap), trap);
+        instantiate.push_back(elapsedNs(start));
+
+        wasmtime_extern_t init;
+        if (ok && wasmtime_instance_export_get(context, &instance, "_initialize", 11, &init)) {
+            start = Clock::now();
+            check("_initialize", wasmtime_func_call(context, &init.of.func, nullptr, 0, nullptr, 0, &trap), trap);
+            initialize.push_back(elapsedNs(start));
+        }
+
+        start = Clock::now();
+        wasmtime_store_delete(store);
+        storeDrop.push_back(elapsedNs(start));
+    }
+    report.phase(name, "store_create", storeCreate);
+    report.phase(name, "instantiate", instantiate);
+    report.phase(name, "initialize", initialize);
+    report.phase(name, "store_drop", storeDrop);
+}
+
+// run_entry: 同一实例上反复 dispatch (只含调用本身)，以及完整的一次性 call
+static void benchRunEntry(Report& report, const Options& opt, WasmModule* module, const std::string& name) {
+    for (size_t payload : opt.payloads) {
+        std::string json(std::min(payload, kMaxPayload), 'x');
+        std::string out;
+        std::string tag = "[payload=" + std::to_string(json.size()) + "]";
+
+        WasmExecutor exec(module);
+        if (!exec.instantiate(out)) {
+            std::cerr << "[bench] " << name << ": " << out << std::endl;
+            return;
+        }
+        std::vector<double> dispatch, call;
+        for (int i = 0; i < opt.iterations; ++i) {
+            auto start = Clock::now();
+            exec.dispatch("echo", json, out);
+            dispatch.push_back(elapsedNs(start));
+
+            start = Clock::now();
+            module->call(std::string_view("echo"), std::string_view(json), out);
+            call.push_back(elapsedNs(start));
+        }
+        report.phase(name, "run_entry" + tag, dispatch);
+        report.phase(name, "call_full" + tag, call);
+    }
+}
+
+// 并发压测: T 个线程同时对同一模块发起完整 call
+static void benchParallel(Report& report, const Options& opt, WasmModule* module, const std::string& name) {
+    std::string json(1024, 'x');
+    std::vector<std::vector<double>> perThread(opt.threads);
+    std::atomic<int> errors{0};
+
+    auto start = Clock::now();
+    std::vector<std::thread> workers;
+    for (int t = 0; t < opt.threads; ++t) {
+        workers.emplace_back([&, t] {
+            std::string out;
+            for (int i = 0; i < opt.iterations; ++i) {
+                auto begin = Clock::now();
+                module->call(std::string_view("echo"), std::string_view(json), out);
+                perThread[t].push_back(elapsedNs(begin));
+                if (out.compare(0, 8, "{\"error\"") == 0) errors++;
+            }
+        });
+    }
+    for (auto& worker : workers) worker.join();
+    double totalSec = elapsedNs(start) / 1e9;
+
+    std::vector<double> all;
+    for (auto& samples : perThread) all.insert(all.end(), samples.begin(), samples.end());
+    report.phase(name, "parallel_call[threads=" + std::to_string(opt.threads) + "]", all);
+
+    std::ostringstream os;
+    os << "{\"module\": \"" << name << "\", \"scenario\": \"parallel\", \"threads\": " << opt.threads
+       << ", \"calls\": " << all.size() << ", \"errors\": " << errors.load()
+       << ", \"calls_per_sec\": " << all.size() / totalSec << "}";
+    report.scenario(os.str());
+}
+
+// 批量调用: B 次单独 call vs 一次 callBatch
+static void benchBatch(Report& report, const Options& opt, WasmModule* module, const std::string& name) {
+    std::string json = "{\"id\": 123}";
+    std::vector<std::pair<std::string_view, std::string_view>> items(opt.batch, {"echo", json});
+    std::vector<std::string> results;
+    std::vector<double> single, batch;
+    std::string out;
+
+    for (int i = 0; i < opt.iterations; ++i) {
+        auto start = Clock::now();
+        for (auto& item : items) module->call(item.first, item.second, out);
+        single.push_back(elapsedNs(start));
+
+        start = Clock::now();
+        module->callBatch(items, results);
+        batch.push_back(elapsedNs(start));
+    }
+    report.phase(name, "single_calls[n=" + std::to_string(opt.batch) + "]", single);
+    report.phase(name, "call_batch[n=" + std::to_string(opt.batch) + "]", batch);
+}
+
+// epoch 中断的固定开销: 同一配置分别关闭 / 打开 epoch 中断，比较不设截止时间时的完整 call
+// 合成插件的 _initialize 含 16K 次循环，回边检查的代价会直接体现在 call_full 上
+static void benchEpochOverhead(Report& report, const Options& opt, const WasmConfig& config,
+                               const std::vector<uint8_t>& wasm) {
+    std::string json(1024, 'x');
+    std::string out;
+    double mean[2] = {0, 0};
+    for (int epoch = 0; epoch < 2; ++epoch) {
+        WasmConfig variant = config;
+        variant.setEpochInterruption(epoch == 1);
+        std::string name = std::string("synthetic[epoch=") + (epoch ? "on" : "off") + "]";
+        WasmModule* module = WasmModule::loadFromSource(wasm, variant);
+        if (!module) return;
+        std::vector<double> samples;
+        for (int i = 0; i < opt.iterations; ++i) {
+            auto start = Clock::now();
+            module->call(std::string_view("echo"), std::string_view(json), out);
+            samples.push_back(elapsedNs(start));
+        }
+        delete module;
+        for (double s : samples) mean[epoch] += s / samples.size();
+        report.phase(name, "call_full[payload=1024]", samples);
+    }
+
+    std::ostringstream os;
+    os << "{\"module\": \"synthetic\", \"scenario\": \"epoch_overhead\", \"mean_off_us\": " << mean[0] / 1000.0
+       << ", \"mean_on_us\": " << mean[1] / 1000.0
+       << ", \"overhead_pct\": " << (mean[0] > 0 ? (mean[1] - mean[0]) / mean[0] * 100.0 : 0.0) << "}";
+    report.scenario(os.str());
+}
+
+// add.wasm 没有 run_entry，单独测直接调用导出函数 add
+static void benchAddExport(Report& report, const Options& opt, WasmModule* module, const std::string& name) {
+    if (!module->getInstancePre()) return;
+    wasmtime_store_t* store = wasmtime_store_new(module->getEngine(), nullptr, nullptr);
+    wasmtime_context_t* context = wasmtime_store_context(store);
+    wasmtime_context_set_wasi(context, wasi_config_new());
+    if (module->hasEpochInterruption()) wasmtime_context_set_epoch_deadline(context, WasmEpochTicker::kNoDeadline);
+
+    wasmtime_instance_t instance;
+    wasm_trap_t* trap = nullptr;
+    wasmtime_extern_t item;
+    if (check("instantiate", wasmtime_instance_pre_instantiate(module->getInstancePre(), context, &instance, &trap), trap)) {
+        if (wasmtime_instance_export_get(context, &instance, "_initialize", 11, &item)) {
+            check("_initialize", wasmtime_func_call(context, &item.of.func, nullptr, 0, nullptr, 0, &trap), trap);
+        }
+        if (wasmtime_instance_export_get(context, &instance, "add", 3, &item)) {
+            wasmtime_val_t args[2], ret;
+            args[0].kind = WASMTIME_I32; args[0].of.i32 = 55;
+            args[1].kind = WASMTIME_I32; args[1].of.i32 = 22;
+            std::vector<double> samples;
+            for (int i = 0; i < opt.iterations; ++i) {
+                auto start = Clock::now();
+                if (!check("add", wasmtime_func_call(context, &item.of.func, args, 2, &ret, 1, &trap), trap)) break;
+                samples.push_back(elapsedNs(start));
+            }
+            report.phase(name, "call_export_add", samples);
+        }
+    }
+    wasmtime_store_delete(store);
+}
+
+// --- 入口 ---
+
+static std::vector<size_t> parseList(const std::string& text) {
+    std::vector<size_t> values;
+    std::stringstream ss(text);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (!item.empty()) values.push_back(std::stoul(item));
+    }
+    return values;
+}
+
+static bool parseOptions(int argc, char** argv, Options& opt) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto next = [&]() -> std::string { return i + 1 < argc ? argv[++i] : ""; };
+        if (arg == "--iterations") opt.iterations = std::max(1, std::stoi(next()));
+        else if (arg == "--payload") opt.payloads = parseList(next());
+        else if (arg == "--threads") opt.threads = std::stoi(next());
+        else if (arg == "--batch") opt.batch = std::max(1, std::stoi(next()));
+        else if (arg == "--profile") opt.profile = next();
+        else if (arg == "--wasm") opt.wasmPath = next();
+        else if (arg == "--out") opt.outPath = next();
+        else if (arg == "--profiler") opt.profiler = next();
+        else {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            return false;
+        }
+    }
+    if (opt.threads <= 0) opt.threads = std::max(1u, std::thread::hardware_concurrency());
+    return true;
+}
+
+int main(int argc, char** argv) {
+    Options opt;
+    if (!parseOptions(argc, argv, opt)) return 1;
+
+    WasmConfig config;
+    if (!WasmConfig::fromName(opt.profile, config)) {
+        std::cerr << "Unknown profile: " << opt.profile << std::endl;
+        return 1;
+    }
+    if (!opt.profiler.empty()) {
+        WasmProfiler profiler;
+        if (!WasmConfig::profilerFromName(opt.profiler, profiler)) {
+            std::cerr << "Unknown profiler: " << opt.profiler << std::endl;
+            return 1;
+        }
+        config.setProfiler(profiler);
+    }
+    wasm_engine_t* engine = WasmEngineRegistry::acquire(config);
+    if (!engine) return 1;
+
+    Report report;
+    benchEngineCreate(report, opt, config);
+
+    // 1. add.wasm (真实的 Kotlin/Wasm 产物)
+    std::vector<uint8_t> addWasm = JniUtils::readFile(opt.wasmPath);
+    if (addWasm.empty()) {
+        std::cerr << "[bench] Failed to read " << opt.wasmPath << ", skip" << std::endl;
+    } else {
+        benchCompile(report, opt, engine, "add.wasm", addWasm);
+        if (WasmModule* module = WasmModule::loadFromSource(addWasm, config)) {
+            benchInstantiate(report, opt, module, "add.wasm");
+            benchAddExport(report, opt, module, "add.wasm");
+            delete module;
+        }
+    }
+
+    // 2. 合成插件 (走完整的 run_entry 调用链)
+    wasm_byte_vec_t synthetic;
+    if (!check("wat2wasm", wasmtime_wat2wasm(kSyntheticPluginWat, strlen(kSyntheticPluginWat), &synthetic))) return 1;
+    std::vector<uint8_t> pluginWasm(synthetic.data, synthetic.data + synthetic.size);
+    wasm_byte_vec_delete(&synthetic);
+
+    benchCompile(report, opt, engine, "synthetic", pluginWasm);
+    if (WasmModule* module = WasmModule::loadFromSource(pluginWasm, config)) {
+        benchInstantiate(report, opt, module, "synthetic");
+        benchRunEntry(report, opt, module, "synthetic");
+        benchParallel(report, opt, module, "synthetic");
+        benchBatch(report, opt, module, "synthetic");
+        // 模块常开计数器: 全部场景累计的各阶段耗时与 Host 调用 / 字节数
+        report.scenario("{\"module\": \"synthetic\", \"scenario\": \"stats\", \"counters\": " +
+                        module->stats().toJson() + "}");
+        report.scenario(module->getMetrics().snapshot(WasmMetrics::Format::Json, "synthetic"));
+        benchEpochOverhead(report, opt, config, pluginWasm);
+
+        // 3. 同一插件经 .cwasm 加载: 先释放 JIT 产物，确保 loadFromPath 真正走反序列化
+        std::string cwasmPath = "/tmp/wasmline_bench_" + std::to_string(getpid()) + ".cwasm";
+        bool saved = module->saveCacheToPath(cwasmPath);
+        delete module;
+        if (saved) {
+            if (WasmModule* aot = WasmModule::loadFromPath(cwasmPath, config)) {
+                benchRunEntry(report, opt, aot, "synthetic.cwasm");
+                delete aot;
+            }
+            unlink(cwasmPath.c_str());
+            unlink(WasmModuleCache::headerPath(cwasmPath).c_str());
+        }
+    }
+
+    std::string json = report.toJson(opt, config);
+    if (opt.outPath.empty()) {
+        std::cout << json;
+    } else {
+        std::ofstream(opt.outPath) << json;
+        std::cerr << "[bench] Result written to " << opt.outPath << std::endl;
+    }
+    return 0;
+}
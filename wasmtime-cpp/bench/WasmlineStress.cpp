@@ -0,0 +1,434 @@
+// WasmlineStress.cpp
+// 并发压力测试: 多个线程同时对同一个 WasmModule 发起 call / callBatch / 会话调用，
+// 期间另一线程不断替换调用配置 (资源上限、WASI 策略、日志 Tag)；随后在异步调用仍在排队 / 执行时释放模块，
+// 并发写同一个 .cwasm 缓存文件，并验证线性内存上限、WASI 建立失败与预初始化模块的纯函数声明。每个结果都与期望值逐字节比对，任何错误或不符都以非 0 退出码结束。
+//
+// 用法: wasmline_stress [--threads T] [--iterations N] [--rounds R]
+//                       [--profile android-safe|android-interruptible|linux-server-fast|fast-startup]
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <unistd.h>
+
+#include "WasmConfig.h"
+#include "WasmEpochTicker.h"
+#include "WasmLogSink.h"
+#include "WasmModule.h"
+#include "WasmModuleCache.h"
+#include "WasmSession.h"
+
+// 回显插件: run_entry 原样回写 json；action 为 "log" 时先把 json 写到 WASI stdout，为 "trap" 时直接 Trap
+// "grow" 逐页增长线性内存直到失败 (最多 256 页)，以 4 字节小端返回最终页数；"oom" 增长到失败后 Trap
+// 导入 WASI，使每个 Store 都要按当前配置快照构建 WASI 上下文
+static const char* kEchoPluginWat = R"WAT(
+(module
+  (import "wasi_snapshot_preview1" "fd_write" (func $fd_write (param i32 i32 i32 i32) (result i32)))
+  (import "env" "host_get_action_size" (func $action_size (result i32)))
+  (import "env" "host_get_json_size" (func $json_size (result i32)))
+  (import "env" "host_read_input" (func $read (param i32 i32 i32) (result i32)))
+  (import "env" "host_write_result" (func $write (param i32 i32)))
+  (memory (export "memory") 4)
+  (func (export "_initialize"))
+  (func $grow_all (result i32)
+    (local $n i32)
+    (block $done
+      (loop $more
+        (br_if $done (i32.eq (memory.grow (i32.const 1)) (i32.const -1)))
+        (local.set $n (i32.add (local.get $n) (i32.const 1)))
+        (br_if $more (i32.lt_u (local.get $n) (i32.const 256)))))
+    (memory.size))
+  (func (export "run_entry")
+    (local $a i32) (local $j i32) (local $c i32)
+    (local.set $a (call $action_size))
+    (local.set $j (call $json_size))
+    (drop (call $read (i32.const 0) (i32.const 1024) (local.get $a)))
+    (drop (call $read (i32.const 1) (i32.const 4096) (local.get $j)))
+    (if (i32.gt_u (local.get $a) (i32.const 0))
+      (then
+        (local.set $c (i32.load8_u (i32.const 1024)))
+        (if (i32.eq (local.get $c) (i32.const 116)) (then unreachable))
+        (if (i32.eq (local.get $c) (i32.const 103))
+          (then
+            (i32.store (i32.const 0) (call $grow_all))
+            (call $write (i32.const 0) (i32.const 4))
+            (return)))
+        (if (i32.eq (local.get $c) (i32.const 111))
+          (then
+            (drop (call $grow_all))
+            unreachable))
+        (if (i32.eq (local.get $c) (i32.const 108))
+          (then
+            (i32.store (i32.const 0) (i32.const 4096))
+            (i32.store (i32.const 4) (local.get $j))
+            (drop (call $fd_write (i32.const 1) (i32.const 0) (i32.const 1) (i32.const 8)))))))
+    (call $write (i32.const 4096) (local.get $j)))
+)
+)WAT";
+
+// 预初始化插件: 带 __wasmline_preinitialized 标记 (不执行 _initialize)，经 __wasmline_declare_pure 把 "echo" 声明为纯函数
+static const char* kPreinitPluginWat = R"WAT(
+(module
+  (import "env" "host_get_json_size" (func $json_size (result i32)))
+  (import "env" "host_read_input" (func $read (param i32 i32 i32) (result i32)))
+  (import "env" "host_write_result" (func $write (param i32 i32)))
+  (import "env" "host_declare_pure" (func $declare_pure (param i32 i32)))
+  (memory (export "memory") 1)
+  (data (i32.const 0) "echo")
+  (func (export "__wasmline_preinitialized"))
+  (func (export "__wasmline_declare_pure") (call $declare_pure (i32.const 0) (i32.const 4)))
+  (func (export "run_entry")
+    (local $j i32)
+    (local.set $j (call $json_size))
+    (drop (call $read (i32.const 1) (i32.const 1024) (local.get $j)))
+    (call $write (i32.const 1024) (local.get $j)))
+)
+)WAT";
+
+static const std::string kRunTrap = "{\"error\": \"Run Trap\"}";
+static const std::string kCancelled = "{\"error\": \"Cancelled\"}";
+
+struct Options {
+    int threads = 0;
+    int iterations = 200;
+    int rounds = 20;
+    std::string profile = "default";
+};
+
+// --- 失败记录: 计数并只打印前几条 ---
+
+static std::atomic<int> g_failures{0};
+static std::mutex g_printLock;
+
+static void fail(const std::string& scenario, const std::string& detail) {
+    if (g_failures.fetch_add(1) < 20) {
+        std::lock_guard<std::mutex> guard(g_printLock);
+        std::cerr << "[stress] FAIL " << scenario << ": " << detail << std::endl;
+    }
+}
+
+static void expect(const std::string& scenario, const std::string& actual, const std::string& expected) {
+    if (actual != expected) fail(scenario, "expected " + expected.substr(0, 80) + ", got " + actual.substr(0, 80));
+}
+
+// 每个 (线程, 序号) 的载荷各不相同，长度也不同，串线或截断都能被发现
+// 写日志的载荷限制在一个日志槽位 (220 字节) 以内，保证每条日志都是完整的一行
+static std::string payload(int thread, int index, size_t maxPad = 997) {
+    return "{\"t\":" + std::to_string(thread) + ",\"i\":" + std::to_string(index) + ",\"pad\":\"" +
+           std::string((size_t)(thread * 31 + std::abs(index) * 7) % maxPad, 'x') + "\"}";
+}
+
+// Guest 日志后端: Tag 只能是默认值、当前快照里的某个 stress-* 或框架自身；内容必须是完整的载荷
+static std::atomic<int> g_logLines{0};
+
+static void checkLogLine(WasmLogLevel, const char* tag, const char* message, size_t length) {
+    std::string text(message, length);
+    g_logLines++;
+    if (strcmp(tag, TAG) == 0 || text.find("log lines dropped") != std::string::npos) return;
+    if (strcmp(tag, "WasmGuest") != 0 && strncmp(tag, "stress-", 7) != 0) fail("log", std::string("torn tag ") + tag);
+    if (text.compare(0, 5, "{\"t\":") != 0 || text.back() != '}') fail("log", "torn line " + text.substr(0, 80));
+}
+
+// --- 场景 ---
+
+// 同一模块上 T 个线程混合发起 call / 限时 call / callBatch / 会话调用 / 带日志的调用 / Trap，
+// 同时一个线程不停替换调用配置
+static void stressCalls(const Options& opt, WasmModule* module) {
+    std::atomic<bool> stop{false};
+    std::thread churn([&] {
+        for (int k = 0; !stop.load(); ++k) {
+            WasmStoreLimits limits;
+            limits.memorySize = (k % 2) ? 64LL * 1024 * 1024 : -1;
+            module->setCallLimits(limits);
+            module->setLogTag("stress-" + std::to_string(k % 8));
+            WasmWasiPolicy policy;
+            policy.setEnv("STRESS_ROUND", std::to_string(k)).setArgs({"stress", std::to_string(k)});
+            module->setWasiPolicy(policy);
+            std::this_thread::yield();
+        }
+    });
+
+    bool epoch = module->hasEpochInterruption();
+    std::vector<std::thread> workers;
+    for (int t = 0; t < opt.threads; ++t) {
+        workers.emplace_back([&, t] {
+            std::unique_ptr<WasmSession> session(WasmSession::open(module));
+            if (!session) fail("session", "open failed");
+            std::string out;
+            for (int i = 0; i < opt.iterations; ++i) {
+                std::string json = payload(t, i);
+                switch (i % 6) {
+                    case 0:
+                        module->call(std::string_view("echo"), std::string_view(json), out);
+                        expect("call", out, json);
+                        break;
+                    case 1:
+                        // 足够宽的截止时间，只覆盖 epoch 截止时间的设置与恢复路径
+                        expect("call_timeout", module->call("echo", json, epoch ? 10000 : -1), json);
+                        break;
+                    case 2:
+                        json = payload(t, i, 150);
+                        expect("call_log", module->call("log", json), json);
+                        break;
+                    case 3:
+                        expect("call_trap", module->call("trap", json), kRunTrap);
+                        break;
+                    case 4: {
+                        // Trap 之后实例重建，后续项不受影响
+                        std::string second = payload(t, -i, 150);
+                        std::vector<std::pair<std::string_view, std::string_view>> items = {
+                            {"echo", json}, {"trap", json}, {"log", second}, {"echo", second}};
+                        std::vector<std::string> results;
+                        module->callBatch(items, results);
+                        if (results.size() != items.size()) {
+                            fail("batch", "result count " + std::to_string(results.size()));
+                            break;
+                        }
+                        expect("batch[0]", results[0], json);
+                        expect("batch[1]", results[1], kRunTrap);
+                        expect("batch[2]", results[2], second);
+                        expect("batch[3]", results[3], second);
+                        break;
+                    }
+                    default:
+                        json = payload(t, i, 150);
+                        if (session) expect("session", session->call(i % 2 ? "echo" : "log", json), json);
+                        break;
+                }
+            }
+        });
+    }
+    for (auto& worker : workers) worker.join();
+    stop = true;
+    churn.join();
+}
+
+// "grow" 的返回值: 最终页数，格式不对时为 -1
+static int64_t grownPages(const std::string& result) {
+    if (result.size() != 4) return -1;
+    uint32_t pages;
+    memcpy(&pages, result.data(), sizeof(pages));
+    return pages;
+}
+
+// 资源上限确实生效: 线性内存恰好停在上限，触顶后的失败保持 Guest 原本的错误
+static void stressLimits(const WasmConfig& config, const std::vector<uint8_t>& wasm) {
+    WasmModule* module = WasmModule::loadFromSource(wasm, config);
+    if (!module) {
+        fail("limits", "load failed");
+        return;
+    }
+    // 初始 4 页，不限制时增长 256 页
+    int64_t unlimited = grownPages(module->call("grow", "{}"));
+    if (unlimited != 260) fail("limits", "unlimited grow stopped at " + std::to_string(unlimited) + " pages");
+
+    WasmStoreLimits limits;
+    limits.memorySize = 1024 * 1024;
+    module->setCallLimits(limits);
+    int64_t limited = grownPages(module->call("grow", "{}"));
+    if (limited != 16) fail("limits", "1MiB limit: grow stopped at " + std::to_string(limited) + " pages");
+    expect("limits_trap", module->call("oom", "{}"), kRunTrap);
+    // 触顶的调用不影响之后的调用
+    expect("limits_after", module->call("echo", "{\"ok\":1}"), "{\"ok\":1}");
+
+    // 会话使用自己的上限，内存跨调用保留: 第二次增长立即失败
+    WasmStoreLimits sessionLimits;
+    sessionLimits.memorySize = 2 * 1024 * 1024;
+    std::unique_ptr<WasmSession> session(WasmSession::open(module, sessionLimits));
+    if (!session) {
+        fail("limits", "session open failed");
+    } else {
+        int64_t first = grownPages(session->call("grow", "{}"));
+        int64_t second = grownPages(session->call("grow", "{}"));
+        if (first != 32 || second != 32) {
+            fail("limits", "2MiB session: grow stopped at " + std::to_string(first) + " / " + std::to_string(second));
+        }
+    }
+    session.reset();
+    delete module;
+}
+
+// WASI 上下文建立失败 (预打开目录不存在) 时调用返回错误，不进入 Wasm；恢复策略后调用正常
+static void stressWasiSetup(const WasmConfig& config, const std::vector<uint8_t>& wasm) {
+    WasmModule* module = WasmModule::loadFromSource(wasm, config);
+    if (!module) {
+        fail("wasi_setup", "load failed");
+        return;
+    }
+    WasmWasiPolicy broken;
+    broken.addPreopen("/nonexistent/wasmline_stress", "/data");
+    module->setWasiPolicy(broken);
+    const std::string expected = "{\"error\": \"WASI Setup Failed\", \"reason\": \"preopen\"}";
+    expect("wasi_setup", module->call("log", "{\"t\":0}"), expected);
+    std::vector<std::string> results;
+    module->callBatch({{"echo", "{}"}, {"log", "{}"}}, results);
+    for (const auto& result : results) expect("wasi_setup_batch", result, expected);
+
+    module->setWasiPolicy(WasmWasiPolicy());
+    expect("wasi_setup_restored", module->call("echo", "{\"ok\":1}"), "{\"ok\":1}");
+    delete module;
+}
+
+// 预初始化模块的纯函数声明在加载时补上: 相同请求第二次命中结果缓存
+static void stressPreinitPure(const WasmConfig& config) {
+    wasm_byte_vec_t binary;
+    if (wasmtime_error_t* err = wasmtime_wat2wasm(kPreinitPluginWat, strlen(kPreinitPluginWat), &binary)) {
+        wasmtime_error_delete(err);
+        fail("preinit_pure", "wat2wasm failed");
+        return;
+    }
+    std::vector<uint8_t> wasm(binary.data, binary.data + binary.size);
+    wasm_byte_vec_delete(&binary);
+
+    WasmModule* module = WasmModule::loadFromSource(wasm, config);
+    if (!module || !module->isPreInitialized()) {
+        fail("preinit_pure", module ? "not detected as pre-initialized" : "load failed");
+        delete module;
+        return;
+    }
+    WasmResultCache& cache = module->getResultCache();
+    if (!cache.isPure("echo")) fail("preinit_pure", "echo was not declared pure at load time");
+    cache.configure(1024 * 1024);
+    expect("preinit_pure", module->call("echo", "{\"n\":1}"), "{\"n\":1}");
+    expect("preinit_pure", module->call("echo", "{\"n\":1}"), "{\"n\":1}");
+    if (cache.hits() != 1) fail("preinit_pure", "expected 1 cache hit, got " + std::to_string(cache.hits()));
+    delete module;
+}
+
+// 模块释放与异步调用并发: 多个线程提交 callAsync 后立即释放模块，
+// 释放必须等到全部已受理的任务回调完毕，每个回调恰好一次且结果正确 (或被取消)
+static void stressClose(const Options& opt, const WasmConfig& config, const std::vector<uint8_t>& wasm) {
+    for (int round = 0; round < opt.rounds; ++round) {
+        WasmModule* module = WasmModule::loadFromSource(wasm, config);
+        if (!module) {
+            fail("close", "load failed");
+            return;
+        }
+        bool epoch = module->hasEpochInterruption();
+        auto token = epoch ? std::make_shared<WasmCancelToken>() : nullptr;
+
+        std::atomic<int> accepted{0}, completed{0};
+        std::vector<std::unique_ptr<std::atomic<int>>> calls;
+        int perThread = std::max(1, opt.iterations / 4);
+        for (int n = 0; n < opt.threads * perThread; ++n) calls.emplace_back(new std::atomic<int>(0));
+
+        std::vector<std::thread> submitters;
+        for (int t = 0; t < opt.threads; ++t) {
+            submitters.emplace_back([&, t] {
+                for (int i = 0; i < perThread; ++i) {
+                    std::string json = payload(t, i, 150);
+                    std::atomic<int>* seen = calls[t * perThread + i].get();
+                    // 一半任务带取消令牌，释放前统一取消
+                    auto taskToken = (i % 2) ? token : nullptr;
+                    bool ok = module->callAsync(i % 3 ? "echo" : "log", json, -1, taskToken,
+                                                [&completed, seen, json, taskToken](std::string& result) {
+                        if (seen->fetch_add(1) != 0) fail("close", "callback ran twice");
+                        if (result != json && !(taskToken && result == kCancelled)) {
+                            fail("close", "unexpected result " + result.substr(0, 80));
+                        }
+                        completed++;
+                    });
+                    if (ok) accepted++;
+                }
+            });
+        }
+        for (auto& submitter : submitters) submitter.join();
+
+        if (token) token->cancel();
+        delete module;
+
+        // callAsync 在回调返回后才归还在途计数，析构返回时每个已受理的回调都应已执行完
+        int done = completed.load();
+        if (done != accepted.load()) {
+            fail("close", "released with " + std::to_string(accepted.load() - done) + " callbacks outstanding");
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        if (completed.load() != done) fail("close", "callback ran after release");
+    }
+}
+
+// 多个线程同时把同一模块写到同一个缓存路径，写完后必须能正常加载
+static void stressCacheWrite(const Options& opt, const WasmConfig& config, WasmModule* module) {
+    std::string path = "/tmp/wasmline_stress_" + std::to_string(getpid()) + ".cwasm";
+    std::vector<std::thread> writers;
+    for (int t = 0; t < opt.threads; ++t) {
+        writers.emplace_back([&] {
+            if (!module->saveCacheToPath(path)) fail("cache", "save failed");
+        });
+    }
+    for (auto& writer : writers) writer.join();
+
+    if (WasmModule* aot = WasmModule::loadFromPath(path, config)) {
+        std::string json = payload(0, 0);
+        expect("cache", aot->call("echo", json), json);
+        delete aot;
+    } else {
+        fail("cache", "load from " + path + " failed");
+    }
+    unlink(path.c_str());
+    unlink(WasmModuleCache::headerPath(path).c_str());
+}
+
+static bool parseOptions(int argc, char** argv, Options& opt) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto next = [&]() -> std::string { return i + 1 < argc ? argv[++i] : ""; };
+        if (arg == "--threads") opt.threads = std::stoi(next());
+        else if (arg == "--iterations") opt.iterations = std::max(1, std::stoi(next()));
+        else if (arg == "--rounds") opt.rounds = std::max(1, std::stoi(next()));
+        else if (arg == "--profile") opt.profile = next();
+        else {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            return false;
+        }
+    }
+    if (opt.threads <= 0) opt.threads = (int)std::min(16u, std::max(2u, std::thread::hardware_concurrency() * 2));
+    return true;
+}
+
+int main(int argc, char** argv) {
+    Options opt;
+    if (!parseOptions(argc, argv, opt)) return 2;
+
+    WasmConfig config;
+    if (!WasmConfig::fromName(opt.profile, config)) {
+        std::cerr << "Unknown profile: " << opt.profile << std::endl;
+        return 2;
+    }
+    WasmLogSink::setBackend(checkLogLine);
+
+    wasm_byte_vec_t binary;
+    if (wasmtime_error_t* err = wasmtime_wat2wasm(kEchoPluginWat, strlen(kEchoPluginWat), &binary)) {
+        wasmtime_error_delete(err);
+        std::cerr << "[stress] wat2wasm failed" << std::endl;
+        return 1;
+    }
+    std::vector<uint8_t> wasm(binary.data, binary.data + binary.size);
+    wasm_byte_vec_delete(&binary);
+
+    WasmModule* module = WasmModule::loadFromSource(wasm, config);
+    if (!module) {
+        std::cerr << "[stress] Failed to load echo plugin" << std::endl;
+        return 1;
+    }
+    std::cerr << "[stress] " << config.describe() << ", threads=" << opt.threads
+              << ", iterations=" << opt.iterations << ", rounds=" << opt.rounds << std::endl;
+
+    stressCalls(opt, module);
+    stressCacheWrite(opt, config, module);
+    delete module;
+    stressLimits(config, wasm);
+    stressWasiSetup(config, wasm);
+    stressPreinitPure(config);
+    stressClose(opt, config, wasm);
+    WasmLogSink::flush();
+
+    int failures = g_failures.load();
+    std::cerr << "[stress] " << (failures ? "FAILED" : "OK") << ": " << failures << " failure(s), "
+              << g_logLines.load() << " guest log line(s)" << std::endl;
+    return failures ? 1 : 0;
+}
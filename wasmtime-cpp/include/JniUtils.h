@@ -5,8 +5,13 @@
 
 namespace JniUtils {
     bool fileExists(const std::string& path);
+    // 文件大小，不存在时返回 -1
+    int64_t fileSize(const std::string& path);
     std::vector<uint8_t> readFile(const std::string& path);
     bool writeFile(const std::string& path, const std::vector<uint8_t>& data);
+    // 原子写入: 先写临时文件并 fsync，再 rename 覆盖目标，任何一步失败都返回 false 且不留下半截文件
+    // 失败原因写入 error (可为空)
+    bool writeFileAtomic(const std::string& path, const uint8_t* data, size_t size, std::string* error = nullptr);
 }
 
 #endif //JNI_UTILS_H
\ No newline at end of file
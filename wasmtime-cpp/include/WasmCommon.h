@@ -4,7 +4,11 @@
 #include <string>
 #include <vector>
 #include <memory>
+#ifdef __ANDROID__
 #include <android/log.h>
+#else
+#include <cstdio>
+#endif
 
 // Wasmtime C API
 #include "wasm.h"
@@ -12,7 +16,15 @@
 #include "wasmtime.h"
 
 #define TAG "WasmCore"
+#ifdef __ANDROID__
 #define LOGI(...) __android_log_print(ANDROID_LOG_INFO, TAG, __VA_ARGS__)
 #define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, TAG, __VA_ARGS__)
+#else
+// 桌面 / 服务器: 输出到 stderr，格式仿照 logcat
+#define WASM_LOG_STDERR(level, ...) \
+    do { fprintf(stderr, level "/" TAG ": "); fprintf(stderr, __VA_ARGS__); fputc('\n', stderr); } while (0)
+#define LOGI(...) WASM_LOG_STDERR("I", __VA_ARGS__)
+#define LOGE(...) WASM_LOG_STDERR("E", __VA_ARGS__)
+#endif
 
 #endif //WASM_COMMON_H
\ No newline at end of file
@@ -2,13 +2,163 @@
 #define WASM_CONFIG_H
 #include "WasmCommon.h"
 
+/**
+ * Pooling 实例分配器配置
+ *
+ * 启用后 Engine 预先保留固定数量的实例 / 内存 / 表槽位，每次 call 新建的 Store 直接复用空闲槽位，
+ * 避免逐次 mmap / munmap。槽位数量即同一 Engine 上可同时存活的实例上限 (WasmSession 常驻占用一个)，
+ * 超过时实例化会失败。
+ * 尺寸类字段为 0 表示沿用 Wasmtime 默认值。
+ */
+struct WasmPoolingConfig {
+    bool enabled = false;
+    uint32_t totalInstances = 0;     // 同时存活的实例数
+    uint32_t totalMemories = 0;      // 线性内存槽位数
+    uint32_t totalTables = 0;        // 表槽位数
+    uint32_t totalGcHeaps = 0;       // GC 堆槽位数
+    size_t maxMemorySize = 0;        // 单个线性内存的最大字节数
+    size_t tableElements = 0;        // 单个表的最大元素数
+    uint32_t maxUnusedWarmSlots = 0; // 保持 "温热" (已提交页) 的空闲槽位数
+    size_t keepResident = 0;         // 槽位回收时保留常驻、仅做 memset 的字节数
+};
+
+/**
+ * 单个 Store 的资源上限 (对应 wasmtime_store_limiter)，-1 表示不限制
+ *
+ * 线性内存按字节计 (会向下取整到 64KiB 页)；Kotlin/Wasm 的对象分配在 GC 堆上，
+ * C API 暂无 GC 堆上限，这里只能约束线性内存、表与实例数量。
+ */
+struct WasmStoreLimits {
+    int64_t memorySize = -1;    // 单个线性内存的最大字节数
+    int64_t tableElements = -1; // 单个表的最大元素数
+    int64_t instances = -1;     // 实例数
+    int64_t tables = -1;        // 表数量
+    int64_t memories = -1;      // 线性内存数量
+
+    bool isLimited() const {
+        return memorySize >= 0 || tableElements >= 0 || instances >= 0 || tables >= 0 || memories >= 0;
+    }
+};
+
+/**
+ * JIT 代码的 Profiler 接入方式 (wasmtime_config_profiler_set)
+ * PerfMap 写 /tmp/perf-<pid>.map，perf report 可直接解析；JitDump 写 jit-<pid>.dump，需 perf inject --jit；
+ * VTune 需要 libwasmtime 启用 vtune 特性。三者都会注册 JIT 编译与 .cwasm 反序列化得到的代码。
+ */
+enum class WasmProfiler { None, PerfMap, JitDump, VTune };
+
+/**
+ * Wasmtime 引擎配置 (Builder)
+ *
+ * 通过命名 Profile 获取一组预设，再用 setXxx 链式微调，最后 build() 生成 wasm_config_t。
+ * 取值为 -1 / 0 的尺寸类字段表示沿用 Wasmtime 默认值。
+ */
 class WasmConfig {
 public:
+    // --- 命名 Profile ---
+    // android-safe: 兼容性优先，SIMD关闭, 信号关闭, 内存保护页为0, 栈 512KB，不插入 epoch 检查
+    static WasmConfig androidSafe();
+    // android-interruptible: 在 android-safe 基础上启用 epoch 中断，支持超时 / 取消 / 采样
+    static WasmConfig androidInterruptible();
+    // linux-server-fast: 桌面/服务器，开启 SIMD 与信号 Trap，沿用 Wasmtime 默认的内存预留与保护页，启用 Pooling 分配器
+    // 并启用 epoch 中断
+    static WasmConfig linuxServerFast();
+    // fast-startup: 在 android-safe 基础上关闭 Cranelift 优化，换取最短的编译时间
+    static WasmConfig fastStartup();
+    // 当前平台的默认 Profile (Android 为 android-safe，其余为 linux-server-fast)
+    static WasmConfig defaultProfile();
+    // 按名字查找 Profile，未知名字返回 false
+    static bool fromName(const std::string& name, WasmConfig& out);
+
+    // --- Wasm 特性 (Kotlin/Wasm 依赖 GC / 函数引用 / 异常处理) ---
+    WasmConfig& setGc(bool v) { gc = v; return *this; }
+    WasmConfig& setFunctionReferences(bool v) { functionReferences = v; return *this; }
+    WasmConfig& setExceptions(bool v) { exceptions = v; return *this; }
+    WasmConfig& setSimd(bool v) { simd = v; return *this; }
+    WasmConfig& setRelaxedSimd(bool v) { relaxedSimd = v; return *this; }
+
+    // --- 编译 ---
+    WasmConfig& setOptLevel(wasmtime_opt_level_t v) { optLevel = v; return *this; }
+    WasmConfig& setParallelCompilation(bool v) { parallelCompilation = v; return *this; }
+
+    // --- 内存与 Trap ---
+    WasmConfig& setSignalsBasedTraps(bool v) { signalsBasedTraps = v; return *this; }
+    WasmConfig& setMemoryGuardSize(int64_t v) { memoryGuardSize = v; return *this; }
+    WasmConfig& setMemoryReservation(int64_t v) { memoryReservation = v; return *this; }
+    WasmConfig& setMaxWasmStack(size_t v) { maxWasmStack = v; return *this; }
+
+    // --- 中断 ---
+    // epoch 中断: 调用超时 / 取消 / 采样的基础 (默认关闭)
+    // 会在每个函数入口与循环回边插入检查代码，即使不设截止时间也要付出这部分开销，
+    // 用 wasmline_bench 的 epoch_overhead 场景可测得具体代价
+    WasmConfig& setEpochInterruption(bool v) { epochInterruption = v; return *this; }
+    bool hasEpochInterruption() const { return epochInterruption; }
+
+    // --- 实例分配策略 (默认按需分配) ---
+    WasmConfig& setPooling(const WasmPoolingConfig& v) { pooling = v; return *this; }
+    const WasmPoolingConfig& getPooling() const { return pooling; }
+
+    // --- 调试与 Backtrace ---
+    WasmConfig& setDebugInfo(bool v) { debugInfo = v; return *this; }
+    WasmConfig& setNativeUnwindInfo(bool v) { nativeUnwindInfo = v; return *this; }
+
+    // --- Profiler ---
+    // 环境变量 WASMLINE_PROFILER (none / perfmap / jitdump / vtune) 优先于这里的设置，无需改代码即可开启
+    WasmConfig& setProfiler(WasmProfiler v) { profiler = v; return *this; }
+    // 实际生效的 Profiler (已合并环境变量)
+    WasmProfiler getProfiler() const;
+    static bool profilerFromName(const std::string& name, WasmProfiler& out);
+
+    // 生成 wasm_config_t (所有权交给调用方，通常随即交给 wasm_engine_new_with_config)
+    wasm_config_t* build() const;
+
     /**
-     * 创建适用于 Android 的 Wasmtime 配置
-     * 包含 GC开启, SIMD关闭, 信号关闭, 内存页为0 等关键设置
+     * 配置指纹 (代码兼容键): 覆盖所有影响编译产物的设置以及 Wasmtime 版本
+     * 写入 .cwasm 缓存头，配置或版本变化后旧的 .cwasm 会在反序列化前被识别为过期
      */
+    uint64_t fingerprint() const;
+    /**
+     * 引擎键: 代码兼容键 + 只影响运行期的设置 (Profiler)
+     * 用作引擎注册表与进程内模块缓存的键；切换 Profiler 会新建 Engine，但磁盘上的 .cwasm 仍然可用
+     */
+    uint64_t engineKey() const;
+
+    // 可读描述，例如 "android-safe(gc=1;simd=0;...;profiler=none)"，用于日志
+    std::string describe() const;
+
+    const std::string& getName() const { return name; }
+
+    // 兼容旧接口: 等价于 androidSafe().build()
     static wasm_config_t* createAndroidConfig();
+
+private:
+    std::string name = "custom";
+
+    bool gc = true;
+    bool functionReferences = true;
+    bool exceptions = true;
+    bool simd = false;
+    bool relaxedSimd = false;
+
+    wasmtime_opt_level_t optLevel = WASMTIME_OPT_LEVEL_SPEED;
+    bool parallelCompilation = true;
+
+    bool signalsBasedTraps = false;
+    int64_t memoryGuardSize = -1;
+    int64_t memoryReservation = -1;
+    size_t maxWasmStack = 0;
+
+    bool epochInterruption = false;
+
+    WasmPoolingConfig pooling;
+
+    bool debugInfo = false;
+    bool nativeUnwindInfo = true;
+
+    WasmProfiler profiler = WasmProfiler::None;
+
+    // 影响编译产物的设置 (不含名字与 Profiler)
+    std::string describeCode() const;
 };
 
 #endif //WASM_CONFIG_H
\ No newline at end of file
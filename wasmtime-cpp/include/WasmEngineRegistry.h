@@ -0,0 +1,24 @@
+#ifndef WASM_ENGINE_REGISTRY_H
+#define WASM_ENGINE_REGISTRY_H
+
+#include "WasmConfig.h"
+
+/**
+ * 进程级 Engine 注册表
+ *
+ * 以 WasmConfig::engineKey() 为键，每种配置只创建一个 Engine，不同 Profile 的模块可以共存。
+ * Engine 与其共享 Linker 创建后常驻进程，永不释放 (模块、Store 均可能仍引用它们)。
+ */
+class WasmEngineRegistry {
+public:
+    // 获取 (必要时创建) 与配置对应的 Engine，失败返回 nullptr
+    static wasm_engine_t* acquire(const WasmConfig& config);
+
+    // Engine 级共享 Linker: 已注册 WASI 与全部内置 Host Functions，同一 Engine 的模块共用
+    static wasmtime_linker_t* sharedLinker(wasm_engine_t* engine);
+
+    // 新建一份带 WASI 与内置 Host Functions 的 Linker (所有权归调用方)
+    static wasmtime_linker_t* createBaseLinker(wasm_engine_t* engine);
+};
+
+#endif //WASM_ENGINE_REGISTRY_H
\ No newline at end of file
@@ -0,0 +1,41 @@
+#ifndef WASM_EPOCH_TICKER_H
+#define WASM_EPOCH_TICKER_H
+
+#include "WasmCommon.h"
+#include <atomic>
+
+/**
+ * 调用取消令牌
+ * 由调用方 (如 Kotlin 协程) 持有，cancel() 后正在执行的 Wasm 调用会在下一个 epoch 检查点被中断
+ */
+class WasmCancelToken {
+public:
+    void cancel() { cancelled.store(true, std::memory_order_release); }
+    bool isCancelled() const { return cancelled.load(std::memory_order_acquire); }
+
+private:
+    std::atomic<bool> cancelled{false};
+};
+
+/**
+ * 进程级 epoch 节拍器
+ *
+ * 单个后台线程每 kTickMs 为所有启用了 epoch 中断的 Engine 递增一次 epoch，
+ * 只有存在带截止时间 / 取消令牌的在途调用时才运行，空闲时挂起不耗电。
+ */
+class WasmEpochTicker {
+public:
+    // 节拍间隔，也是超时判定的精度
+    static constexpr int64_t kTickMs = 5;
+    // 不限时调用使用的 epoch 截止增量 (启用 epoch 中断后每个 Store 都必须设置截止，默认 0 会立即中断)
+    static constexpr uint64_t kNoDeadline = 1ull << 62;
+
+    // 登记启用了 epoch 中断的 Engine (由 WasmEngineRegistry 在创建时调用)
+    static void registerEngine(wasm_engine_t* engine);
+
+    // 在途的限时调用计数: 大于 0 时节拍器运行
+    static void acquire();
+    static void release();
+};
+
+#endif //WASM_EPOCH_TICKER_H
\ No newline at end of file
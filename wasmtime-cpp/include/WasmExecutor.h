@@ -1,35 +1,123 @@
 #ifndef WASM_EXECUTOR_H
 #define WASM_EXECUTOR_H
 #include "WasmCommon.h"
+#include "WasmConfig.h"
+#include "WasmSampler.h"
+#include "WasmLogSink.h"
+#include <chrono>
+#include <string_view>
 
 // 前置声明，避免循环引用
 class WasmModule;
+class WasmCancelToken;
+struct WasmCallConfig;
 
 class WasmExecutor {
 public:
-    WasmExecutor(WasmModule* module, std::string action, std::string json);
+    // 使用模块调用配置快照中的单次调用资源上限
+    explicit WasmExecutor(WasmModule* module);
+    // 显式指定资源上限 (会话)，其余配置仍取自快照
+    WasmExecutor(WasmModule* module, const WasmStoreLimits& limits);
     ~WasmExecutor();
 
-    std::string run();
+    // 从模板实例化并执行 _initialize，整个 Store 生命周期只需一次
+    // 失败时返回 false，error 中写入错误 JSON
+    bool instantiate(std::string& error);
+
+    // 重置输入/输出缓冲并调用 run_entry，可在同一实例上反复调用
+    // 输入只借用调用方内存，结果 (或错误 JSON) 写入 out
+    void dispatch(std::string_view action, std::string_view json, std::string& out);
+    std::string dispatch(std::string_view action, std::string_view json);
+
+    // 实例化后调用一个无参无返回值的导出函数 (不经过 run_entry)，失败时 error 中写入错误 JSON
+    bool invoke(std::string_view name, std::string& error);
+
+    // 一次性调用: instantiate + dispatch
+    void run(std::string_view action, std::string_view json, std::string& out);
+    std::string run(std::string_view action, std::string_view json);
+
+    // 设置后续 instantiate / dispatch 的截止时间与取消令牌 (timeoutMs < 0 表示不限时)
+    // 依赖 Engine 的 epoch 中断，截止时间从调用本方法时开始计算
+    void setDeadline(int64_t timeoutMs, std::shared_ptr<WasmCancelToken> cancelToken = nullptr);
+
+    // run_entry 发生 Trap (含超时 / 取消) 后实例状态不可信，需要丢弃重建
+    bool isPoisoned() const { return poisoned; }
 
     // 注册 Host Functions 到 Linker
     static void registerHostFunctions(wasmtime_linker_t* linker);
 
+    // 按参数/返回值类型构建 functype 并定义到 Linker
+    static bool defineFunction(wasmtime_linker_t* linker, const std::string& moduleName, const std::string& name,
+                               wasmtime_func_callback_t callback,
+                               const std::vector<wasm_valkind_t>& params, const std::vector<wasm_valkind_t>& results,
+                               void* env = nullptr);
+
     // --- 数据缓冲区 (Host Function 需访问) ---
-    std::string inputAction;
-    std::string inputJson;
-    std::string outputResult;
+    // 仅在 dispatch 期间有效: 输入是调用方内存的视图 (std::string / DirectByteBuffer)，不做拷贝
+    std::string_view inputAction;
+    std::string_view inputJson;
+    std::string* outputResult = nullptr;
 
 private:
+    WasmExecutor(WasmModule* module, std::shared_ptr<const WasmCallConfig> config, const WasmStoreLimits* limits);
+
     WasmModule* holder;
+    // 创建 Store 时取得的调用配置快照 (每个 Store 只读一次)，WASI 回调引用其中的数据，需与 Store 同生命周期
+    std::shared_ptr<const WasmCallConfig> callConfig;
+    WasmLogTarget logTarget;
+    // Store 初始化失败 (WASI 上下文未能建立) 时的错误 JSON；非空时 instantiate / dispatch 直接返回它，不进入 Wasm
+    std::string setupError;
     wasmtime_store_t* store = nullptr;
     wasmtime_context_t* context = nullptr;
 
+    wasmtime_instance_t instance{};
+    bool hasInstance = false;
+    wasmtime_func_t runEntry{};
+    WasmStoreLimits limits;
+    bool instantiated = false;
+    bool poisoned = false;
+    // 当前 Wasm 调用期间的 Host 调用次数，调用返回后一次性计入模块统计
+    uint64_t hostCalls = 0;
+
+    // --- 截止时间与取消 ---
+    enum class Interrupt { None, Timeout, Cancelled };
+    bool hasDeadline = false;
+    std::chrono::steady_clock::time_point deadline;
+    std::shared_ptr<WasmCancelToken> cancelToken;
+    Interrupt interrupt = Interrupt::None;
+
+    // --- 采样 (复用 epoch 节拍) ---
+    WasmSampler* sampler = nullptr;
+    WasmSampler::Phase samplePhase = WasmSampler::Phase::Run;
+    std::chrono::steady_clock::time_point lastSample;
+    void sampleIfDue();
+
+    // 调用 Wasm 前后挂上 / 撤下截止检查
+    bool armDeadline();
+    void disarmDeadline(bool armed);
+    // 处理 wasmtime_func_call 的失败返回 (error 或 trap)，返回对应的错误 JSON
+    std::string describeFailure(const char* stage, wasmtime_error_t* err, wasm_trap_t* trap);
+
+    // 导出的线性内存 "memory" 的当前字节数 (没有时为 0)
+    size_t linearMemorySize();
+    // limiter 拒绝增长时 Guest 只会看到 memory.grow 返回 -1，C API 也不提供拒绝回调，无法确知失败是否由触顶引起；
+    // 调用失败时若内存在本次调用中增长到了上限附近，只记录一条提示日志
+    void logMemoryLimitHint(size_t sizeBefore);
+
+    // 每个 epoch 节拍回调一次: 检查取消与超时，未到期则顺延一个节拍
+    static wasmtime_error_t* epoch_callback(wasmtime_context_t* context, void* env,
+                                            uint64_t* epochDeadlineDelta, wasmtime_update_deadline_kind_t* updateKind);
+
     // --- Host Functions 回调 (Static) ---
     static wasm_trap_t* host_get_action_size(void* env, wasmtime_caller_t* caller, const wasmtime_val_t* args, size_t nargs, wasmtime_val_t* results, size_t nresults);
     static wasm_trap_t* host_get_json_size(void* env, wasmtime_caller_t* caller, const wasmtime_val_t* args, size_t nargs, wasmtime_val_t* results, size_t nresults);
     static wasm_trap_t* host_read_input_byte(void* env, wasmtime_caller_t* caller, const wasmtime_val_t* args, size_t nargs, wasmtime_val_t* results, size_t nresults);
     static wasm_trap_t* host_write_result_byte(void* env, wasmtime_caller_t* caller, const wasmtime_val_t* args, size_t nargs, wasmtime_val_t* results, size_t nresults);
+    // 批量 ABI: 直接 memcpy 进出 Guest 线性内存，一次 Host 调用搬运整段数据
+    static wasm_trap_t* host_read_input(void* env, wasmtime_caller_t* caller, const wasmtime_val_t* args, size_t nargs, wasmtime_val_t* results, size_t nresults);
+    static wasm_trap_t* host_write_result(void* env, wasmtime_caller_t* caller, const wasmtime_val_t* args, size_t nargs, wasmtime_val_t* results, size_t nresults);
+    // Guest 声明某个 action 为纯函数 (结果只取决于 action + json)，允许 Host 缓存其结果
+    static wasm_trap_t* host_declare_pure(void* env, wasmtime_caller_t* caller, const wasmtime_val_t* args, size_t nargs, wasmtime_val_t* results, size_t nresults);
 };
 
 #endif //WASM_EXECUTOR_H
\ No newline at end of file
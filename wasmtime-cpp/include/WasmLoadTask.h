@@ -0,0 +1,51 @@
+#ifndef WASM_LOAD_TASK_H
+#define WASM_LOAD_TASK_H
+
+#include "WasmCommon.h"
+#include "WasmConfig.h"
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+
+class WasmModule;
+
+/**
+ * 异步加载任务
+ * 在 Native 工作线程上加载模块: 优先 AOT 缓存 (.cwasm)，未命中再 JIT 编译源码，调用线程不会被阻塞。
+ * 编译完成后先通知等待者，再在同一工作线程上写 .cwasm 缓存，缓存写入不在关键路径上。
+ */
+class WasmLoadTask {
+public:
+    using Callback = std::function<void(bool success)>;
+
+    ~WasmLoadTask();
+
+    // 立即返回任务句柄；cachePath 为空表示不使用磁盘缓存
+    static std::shared_ptr<WasmLoadTask> start(const std::string& sourcePath, const std::string& cachePath,
+                                               const WasmConfig& config = WasmConfig::defaultProfile());
+
+    bool isDone();
+
+    // 等待完成，timeoutMs < 0 表示一直等待；返回是否成功加载 (超时返回 false)
+    bool await(int64_t timeoutMs = -1);
+
+    // 注册完成回调 (在工作线程上执行)；若任务已完成，则在当前线程立即执行
+    void onComplete(Callback callback);
+
+    // 取走加载好的模块 (所有权转移给调用方)，只能成功取走一次；未完成或失败返回 nullptr
+    WasmModule* take();
+
+private:
+    WasmLoadTask() = default;
+    void run(const std::string& sourcePath, const std::string& cachePath, const WasmConfig& config);
+    void complete(WasmModule* loaded);
+
+    std::mutex lock;
+    std::condition_variable cond;
+    bool done = false;
+    bool success = false;
+    WasmModule* module = nullptr;
+    std::vector<Callback> callbacks;
+};
+
+#endif //WASM_LOAD_TASK_H
\ No newline at end of file
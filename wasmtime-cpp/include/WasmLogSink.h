@@ -0,0 +1,68 @@
+#ifndef WASM_LOG_SINK_H
+#define WASM_LOG_SINK_H
+
+#include "WasmCommon.h"
+#include <atomic>
+
+// 日志级别 (数值与 android_LogPriority 一致)
+enum class WasmLogLevel : int {
+    Verbose = 2,
+    Debug = 3,
+    Info = 4,
+    Warn = 5,
+    Error = 6,
+    Off = 7,
+};
+
+/**
+ * 单个模块的 Guest 日志策略: 级别与限流 (每秒最多输出的行数)，均可随时修改
+ * Tag 属于调用配置快照 (WasmCallConfig)，创建 Store 时固定在 WasmLogTarget 里
+ */
+struct WasmLogPolicy {
+    std::atomic<int> level{(int)WasmLogLevel::Info};
+    std::atomic<uint32_t> maxLinesPerSecond{200}; // 0 表示不限流
+
+    // 固定窗口限流: 当前秒内未超额返回 true (限流丢弃的计数以 tag 补报)
+    bool allow(const char* tag);
+
+    std::atomic<int64_t> windowSecond{0};
+    std::atomic<uint32_t> windowCount{0};
+    std::atomic<uint32_t> dropped{0};
+};
+
+/**
+ * 一个 Store 的日志目标: 模块日志策略 + 创建 Store 时的 Tag 快照
+ * 作为 WASI 输出回调的 data，由 Executor 持有，与 Store 同生命周期
+ */
+struct WasmLogTarget {
+    WasmLogPolicy* policy = nullptr;
+    char tag[32] = "WasmGuest";
+
+    void setTag(const std::string& value);
+};
+
+/**
+ * 异步 Guest 日志管道
+ *
+ * WASI stdout / stderr 写入时只把内容拷进无锁环形队列的定长槽位 (不分配内存、不加锁)，
+ * 由后台线程批量取出交给后端输出。队列满或超出限流时直接丢弃，并在之后补一条丢弃计数。
+ * 定义 WASMLINE_LOG_STRIP 编译时，Executor 不再挂接 WASI 输出，日志在编译期整体移除。
+ */
+class WasmLogSink {
+public:
+    // 输出后端 (在后台线程上调用)；默认 Android 走 logcat，其他平台写 stderr
+    using Backend = void (*)(WasmLogLevel level, const char* tag, const char* message, size_t length);
+    static void setBackend(Backend backend);
+
+    // 按行切分后入队 (超长行按槽位大小截断为多条)
+    static void write(WasmLogTarget& target, WasmLogLevel level, const char* data, size_t size);
+
+    // 在当前线程上把队列中剩余的日志全部输出
+    static void flush();
+
+    // WASI 输出回调: data 为 WasmLogTarget*，stdout 记为 Info，stderr 记为 Warn
+    static ptrdiff_t wasiStdout(void* data, const unsigned char* buffer, size_t size);
+    static ptrdiff_t wasiStderr(void* data, const unsigned char* buffer, size_t size);
+};
+
+#endif //WASM_LOG_SINK_H
\ No newline at end of file
@@ -0,0 +1,84 @@
+#ifndef WASM_METRICS_H
+#define WASM_METRICS_H
+
+#include "WasmCommon.h"
+#include <atomic>
+#include <mutex>
+#include <string_view>
+
+/**
+ * HDR 风格的延迟直方图 (纳秒)
+ *
+ * 小于 16ns 的值逐一计数；之后每个 2 的幂区间再等分 8 个子桶，相对误差不超过 12.5%。
+ * 桶数固定，记录只是一次 relaxed 原子加，可在任意线程并发调用。
+ */
+class WasmHistogram {
+public:
+    static constexpr int kSubBuckets = 8;
+    static constexpr int kBuckets = 16 + (64 - 4) * kSubBuckets;
+
+    void record(uint64_t ns);
+    void reset();
+
+    uint64_t count() const { return total.load(std::memory_order_relaxed); }
+    uint64_t sum() const { return sumNs.load(std::memory_order_relaxed); }
+    uint64_t max() const { return maxNs.load(std::memory_order_relaxed); }
+    // 返回分位数所在桶的上界 (q 取 0 ~ 1)
+    uint64_t percentile(double q) const;
+
+private:
+    static int bucketOf(uint64_t ns);
+    static uint64_t upperBoundOf(int bucket);
+
+    std::atomic<uint64_t> buckets[kBuckets] = {};
+    std::atomic<uint64_t> total{0};
+    std::atomic<uint64_t> sumNs{0};
+    std::atomic<uint64_t> maxNs{0};
+};
+
+/**
+ * 按 action 名统计的调用延迟与错误数
+ *
+ * 延迟只覆盖 run_entry 本身，不含 Store 创建、实例化与 _initialize (这些阶段见 WasmStats)，导出时同样标明。
+ * action 按哈希放进定长开放寻址表: 查找无锁 (通常一次字符串比较)，只有首次出现时加锁登记；
+ * 为防止 action 名无限增长，超过 kMaxActions 个之后的新名字统一计入 "_other"。
+ */
+class WasmMetrics {
+public:
+    static constexpr size_t kMaxActions = 256;
+    static constexpr size_t kSlots = 512; // 2 的幂，装载率不超过 50%
+
+    enum class Format { Json, Prometheus };
+
+    // error: 结果为 {"error": ...} 或调用失败
+    void record(std::string_view action, uint64_t ns, bool error);
+
+    // 导出快照；module 非空时作为 Prometheus 标签 / JSON 字段输出
+    std::string snapshot(Format format, const std::string& module = "") const;
+    bool writeSnapshot(const std::string& path, Format format, const std::string& module = "") const;
+
+    // 清零全部计数 (保留已登记的 action)
+    void reset();
+
+private:
+    struct Entry {
+        size_t hash = 0;
+        std::string action;
+        WasmHistogram latency;
+        std::atomic<uint64_t> errors{0};
+    };
+
+    Entry* find(std::string_view action, size_t hash) const;
+    Entry* findOrCreate(std::string_view action);
+
+    std::string toJson(const std::string& module) const;
+    std::string toPrometheus(const std::string& module) const;
+
+    // 槽位只会从空变为非空 (release 发布)，Entry 登记后地址不变、永不删除，无锁读取安全
+    std::atomic<Entry*> slots[kSlots] = {};
+    // 登记新 action 与遍历导出时持有
+    mutable std::mutex lock;
+    std::vector<std::unique_ptr<Entry>> entries;
+};
+
+#endif //WASM_METRICS_H
@@ -2,38 +2,194 @@
 #define WASM_MODULE_H
 
 #include "WasmCommon.h"
+#include "WasmConfig.h"
+#include "WasmLogSink.h"
+#include "WasmWasiPolicy.h"
+#include "WasmStats.h"
+#include "WasmMetrics.h"
+#include "WasmSampler.h"
+#include "WasmResultCache.h"
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string_view>
 
+class WasmCancelToken;
+
+/**
+ * 调用配置快照 (不可变): Store 资源上限、WASI 策略与 Guest 日志 Tag
+ *
+ * 修改时复制一份、改完整体替换，Executor 创建 Store 时取一次快照并持有到 Store 销毁。
+ * 异步调用 (线程池) 与会话重建不在 Kotlin 读写锁的保护范围内，替换配置不会影响仍在使用旧快照的 Store。
+ */
+struct WasmCallConfig {
+    WasmStoreLimits limits; // 每次 call 新建的 Store 使用的资源上限 (默认不限制)
+    std::shared_ptr<const WasmWasiPolicy> wasi = std::make_shared<const WasmWasiPolicy>();
+    std::string logTag = "WasmGuest";
+};
+
+/**
+ * 已加载的 Wasm 模块
+ *
+ * 线程安全: 加载完成后 Engine / Module / Linker / InstancePre 均只读共享，
+ * call 可以在任意多个线程上并发执行，每次调用在调用线程上创建独立的 Store 和 Executor，
+ * Store 从不跨线程共享。defineImport 会修改 Linker，必须在首次 call 之前完成。
+ */
 class WasmModule {
 public:
     ~WasmModule();
 
     // --- 工厂方法 ---
-    // AOT: 从文件路径加载 (.cwasm)
-    static WasmModule* loadFromPath(const std::string& path);
+    // config 决定使用注册表中的哪个 Engine，缺省为当前平台的默认 Profile
+    // 导入无法全部由共享 Linker 解析时加载失败；deferImports 为 true 时改为保留模块，
+    // 由调用方在首次 call 之前通过 defineImport 补齐 (之前的调用返回 {"error": "Unresolved Imports"})
+    // AOT: 从文件路径加载 (.cwasm)，默认 mmap 映射文件，失败时回退到整读进内存
+    static WasmModule* loadFromPath(const std::string& path, const WasmConfig& config = WasmConfig::defaultProfile(),
+                                    bool useMmap = true, bool deferImports = false);
     // JIT: 从内存字节编译 (.wasm)
-    static WasmModule* loadFromSource(const std::vector<uint8_t>& source);
+    static WasmModule* loadFromSource(const std::vector<uint8_t>& source,
+                                      const WasmConfig& config = WasmConfig::defaultProfile(),
+                                      bool deferImports = false);
     // 相比 loadFromSource(vector)，这个方法由 C++ 自己读文件，避免 Java 层 OOM
-    static WasmModule* loadFromSourcePath(const std::string& path);
+    static WasmModule* loadFromSourcePath(const std::string& path,
+                                          const WasmConfig& config = WasmConfig::defaultProfile(),
+                                          bool deferImports = false);
     
     // --- 功能 ---
     // 序列化当前模块并保存到指定路径
     bool saveCacheToPath(const std::string& path);
+    // 同上，但只依赖编译产物本身，可在 WasmModule 释放后于后台线程继续写缓存
+    static bool writeCache(const std::shared_ptr<wasmtime_module_t>& module, bool hasSourceHash, uint64_t sourceHash,
+                           uint64_t configFingerprint, const std::string& path);
+
+    // 追加当前模块专属的 Host 导入 (仅 C++ 宿主可用，常与 deferImports 搭配)
+    // 首次调用时会从共享 Linker 派生出本模块私有的 overlay Linker 并重建实例模板；需在任何 call 之前完成
+    bool defineImport(const std::string& moduleName, const std::string& name,
+                      const std::vector<wasm_valkind_t>& params, const std::vector<wasm_valkind_t>& results,
+                      wasmtime_func_callback_t callback, void* env = nullptr);
+
+    // 每次 call 新建的 Store 使用的资源上限 (默认不限制)，之后新建的 Store 生效，可与调用并发设置
+    void setCallLimits(const WasmStoreLimits& limits);
+    WasmStoreLimits getCallLimits() const { return getCallConfig()->limits; }
+
+    // Guest 日志 (WASI stdout / stderr) 的级别与限流策略 (原子量，可随时修改)
+    WasmLogPolicy& getLogPolicy() { return logPolicy; }
+    // Guest 日志 Tag (最长 31 字节)，之后新建的 Store 生效
+    void setLogTag(const std::string& tag);
+
+    // WASI 策略 (环境变量白名单、argv、预打开目录、标准输出去向)，之后新建的 Store 生效，可与调用并发设置
+    // 模块未导入 WASI 时策略不会生效，Store 完全跳过 WASI 初始化
+    void setWasiPolicy(const WasmWasiPolicy& policy);
+    std::shared_ptr<const WasmWasiPolicy> getWasiPolicy() const { return getCallConfig()->wasi; }
 
-    // 执行调用
+    // 当前调用配置快照 (线程安全)
+    std::shared_ptr<const WasmCallConfig> getCallConfig() const;
+
+    // 执行统计 (Store 创建 / 实例化 / _initialize / run_entry 的耗时与次数、Host 调用数、输入输出字节数)
+    WasmStatsSnapshot stats() const { return counters.snapshot(); }
+    void resetStats() { counters.reset(); }
+    WasmStats& getCounters() { return counters; }
+    // 按 action 统计的 run_entry 延迟直方图与错误数，可导出为 JSON / Prometheus 文本
+    WasmMetrics& getMetrics() { return metrics; }
+
+    // 采样 Profiler: 开启后调用期间每隔 intervalMs 采集一次 Guest 调用栈，按 action 聚合；可在运行时随时开关
+    // 依赖 Engine 的 epoch 中断，未启用时返回 false
+    bool setSampling(bool enabled, int64_t intervalMs = 10);
+    // 已开启采样时返回采样器，否则返回 nullptr (Executor 每次调用前查询)
+    WasmSampler* getActiveSampler() const { return samplingEnabled.load(std::memory_order_acquire) ? sampler.get() : nullptr; }
+    // 采样结果导出 (从未开启过采样时返回空结果)
+    std::string samplingFolded() const { return sampler ? sampler->folded() : ""; }
+    std::string samplingProfile(const std::string& action) {
+        return sampler ? sampler->firefoxProfile(action) : "{\"error\": \"Sampling Disabled\"}";
+    }
+
+    // 纯函数 action 的结果缓存 (默认关闭，configure 开启)；命中时 call 直接返回，不创建 Store、不进入 Wasm
+    // 只缓存声明为纯函数的 action: Host 调用 declarePure，或 Guest 初始化时通过 host_declare_pure 声明
+    // 预初始化模块跳过 _initialize，需导出 __wasmline_declare_pure (加载时调用一次) 才能由 Guest 声明
+    WasmResultCache& getResultCache() { return resultCache; }
+
+    // 执行调用 (线程安全)
     std::string call(const std::string& action, const std::string& json);
+    // 零拷贝调用: 输入只借用调用方内存，结果写入调用方提供 (可复用) 的 out
+    void call(std::string_view action, std::string_view json, std::string& out);
+    // 限时 / 可取消调用: timeoutMs < 0 表示不限时 (覆盖实例化、_initialize 与 run_entry 全程)
+    // 超时返回 {"error": "Timeout"}，被取消返回 {"error": "Cancelled"}；需要 Engine 启用 epoch 中断
+    std::string call(const std::string& action, const std::string& json, int64_t timeoutMs,
+                     const std::shared_ptr<WasmCancelToken>& cancelToken = nullptr);
+    void call(std::string_view action, std::string_view json, std::string& out, int64_t timeoutMs,
+              const std::shared_ptr<WasmCancelToken>& cancelToken = nullptr);
+
+    // 批量调用: 整批共用一个 Store 和实例，_initialize 只执行一次，每项只重置输入输出缓冲区再调用 run_entry
+    // results 与 items 一一对应；某项 Trap 后实例会被重建，不影响后续项
+    void callBatch(const std::vector<std::pair<std::string_view, std::string_view>>& items,
+                   std::vector<std::string>& results);
+
+    // 异步调用: 提交到 Native 线程池 (WasmWorkerPool)，在工作线程上执行并回调 done(result)
+    // 线程池队列已满时返回 false，done 不会被调用
+    // 析构会阻塞调用线程，直到所有已提交 (含仍在排队) 的异步调用执行完毕且回调返回
+    // 回调不能释放 (也不能在工作线程上释放) 仍有异步调用在途的模块，否则析构会等待自己；这种情况直接 abort
+    // 任务在工作线程上运行时调用方的锁早已释放，读取的配置一律来自调用开始时的快照
+    using AsyncCallback = std::function<void(std::string& result)>;
+    bool callAsync(std::string action, std::string json, int64_t timeoutMs,
+                   std::shared_ptr<WasmCancelToken> cancelToken, AsyncCallback done);
 
     // 获取器
     wasm_engine_t* getEngine() const { return engine; }
-    wasmtime_module_t* getModule() const { return module; }
+    wasmtime_module_t* getModule() const { return module.get(); }
+    std::shared_ptr<wasmtime_module_t> getModuleRef() const { return module; }
+    bool getSourceHash(uint64_t& hash) const { hash = sourceHash; return hasSourceHash; }
+    uint64_t getConfigFingerprint() const { return configFingerprint; }
+    // 预初始化快照 (Wizer 等离线工具已执行过初始化): 实例化后不再调用 _initialize
+    bool isPreInitialized() const { return preInitialized; }
+    bool hasEpochInterruption() const { return epochInterruption; }
+    bool isUsingWasi() const { return usesWasi; }
     wasmtime_linker_t* getLinker() const { return linker; }
+    wasmtime_instance_pre_t* getInstancePre() const { return instancePre; }
 
 private:
     WasmModule();
-    bool initCommon(); // 初始化 Engine 和 Linker
+    bool initCommon(const WasmConfig& config); // 从注册表取得 Engine，并挂上该 Engine 的共享 Linker
+    bool initInstancePre(); // 模块就绪后预链接，生成实例模板
+    void inspectModule(); // 扫描导入导出: 识别 WASI 依赖与预初始化快照
+    void capturePureDeclarations(); // 预初始化模块不执行 _initialize，改由 __wasmline_declare_pure 导出补上纯函数声明
+    // 复制当前快照、交给 fn 修改后整体替换
+    template <typename Fn> void updateCallConfig(Fn&& fn);
+    bool finishLoad(bool deferImports); // 加载收尾: inspectModule + initInstancePre，预链接失败时按 deferImports 决定成败
+    bool compileSource(const uint8_t* data, size_t size); // 先查内容寻址缓存，未命中再编译
 
+    // Engine 归 WasmEngineRegistry 所有，本模块只借用
     wasm_engine_t* engine = nullptr;
-    wasmtime_module_t* module = nullptr;
+    uint64_t configFingerprint = 0; // 代码兼容键，写入 / 校验 .cwasm 缓存头
+    uint64_t engineKey = 0;         // 引擎键，进程内模块缓存按它共享编译产物
+    bool epochInterruption = false;
+    bool preInitialized = false;
+    bool usesWasi = true;
+    bool importsDeclarePure = false; // 导入了 env.host_declare_pure
+    bool hasDeclarePure = false;     // 导出了 __wasmline_declare_pure
+    // 编译产物由 WasmModuleCache 共享: 同一份源码 + 同一配置只编译、只驻留一份
+    std::shared_ptr<wasmtime_module_t> module;
+    uint64_t sourceHash = 0;
+    bool hasSourceHash = false;
+    // 默认指向 Engine 级共享 Linker (不归本模块所有)；定义额外导入后换成私有 overlay
     wasmtime_linker_t* linker = nullptr;
+    bool ownsLinker = false;
+    // 预链接的实例模板: 导入只解析一次，每次调用直接从模板实例化
+    wasmtime_instance_pre_t* instancePre = nullptr;
+    WasmLogPolicy logPolicy;
+    mutable std::mutex callConfigLock;
+    std::shared_ptr<const WasmCallConfig> callConfig = std::make_shared<const WasmCallConfig>();
+    WasmStats counters;
+    WasmMetrics metrics;
+    WasmResultCache resultCache;
+    // 采样器首次开启时创建，之后只切换开关，保证在途调用持有的指针一直有效
+    std::unique_ptr<WasmSampler> sampler;
+    std::atomic<bool> samplingEnabled{false};
+    std::mutex samplingLock;
+
+    // 在途异步调用计数，析构时等待归零
+    std::mutex asyncLock;
+    std::condition_variable asyncIdle;
+    int asyncPending = 0;
 };
 
 #endif //WASM_MODULE_H
\ No newline at end of file
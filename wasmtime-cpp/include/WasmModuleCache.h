@@ -0,0 +1,42 @@
+#ifndef WASM_MODULE_CACHE_H
+#define WASM_MODULE_CACHE_H
+
+#include "WasmCommon.h"
+
+/**
+ * .cwasm 缓存头 (写在同名的 <cache>.meta 旁路文件中)
+ * .cwasm 本体保持 Wasmtime 原始格式，这样仍然可以被 mmap 直接反序列化
+ */
+struct WasmCacheHeader {
+    char magic[4];              // "WLCW"
+    uint32_t version;           // 头格式版本
+    uint64_t sourceHash;        // .wasm 源码字节哈希
+    uint64_t configFingerprint; // 引擎配置 + Wasmtime 版本指纹
+    uint64_t payloadSize;       // .cwasm 文件大小，用于发现截断
+};
+
+/**
+ * 内容寻址的编译模块缓存
+ * - 进程内: (源码哈希, 引擎键) -> 共享的 wasmtime_module_t，同一插件加载多次只编译、只驻留一份
+ * - 磁盘: .cwasm 旁路头，反序列化前先校验配置指纹 (代码兼容键) 与 Wasmtime 版本
+ */
+class WasmModuleCache {
+public:
+    using ModuleRef = std::shared_ptr<wasmtime_module_t>;
+
+    // 快速哈希 (MurmurHash64A)
+    static uint64_t hashBytes(const void* data, size_t size, uint64_t seed = 0);
+
+    // 进程内查找，未命中返回空
+    static ModuleRef find(uint64_t sourceHash, uint64_t engineKey);
+    // 登记新编译的模块并接管所有权；若其他线程已抢先登记，则释放 module 并返回已有的那份
+    static ModuleRef put(uint64_t sourceHash, uint64_t engineKey, wasmtime_module_t* module);
+
+    // 旁路头路径: <cachePath>.meta
+    static std::string headerPath(const std::string& cachePath);
+    static bool readHeader(const std::string& cachePath, WasmCacheHeader& header);
+    static bool writeHeader(const std::string& cachePath, uint64_t sourceHash, uint64_t fingerprint, uint64_t payloadSize);
+    static void removeHeader(const std::string& cachePath);
+};
+
+#endif //WASM_MODULE_CACHE_H
\ No newline at end of file
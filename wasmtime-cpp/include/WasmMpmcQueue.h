@@ -0,0 +1,86 @@
+#ifndef WASM_MPMC_QUEUE_H
+#define WASM_MPMC_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+/**
+ * 有界无锁 MPMC 队列 (Dmitry Vyukov 的环形缓冲区算法)
+ *
+ * 每个槽位带一个序号，生产者 / 消费者只通过 CAS 抢占 enqueue / dequeue 位置，
+ * 不需要互斥锁。容量必须是 2 的幂；队列满时 push 返回 false，由调用方决定如何处理。
+ */
+template <typename T>
+class WasmMpmcQueue {
+public:
+    explicit WasmMpmcQueue(size_t capacity) : mask(capacity - 1), cells(new Cell[capacity]) {
+        for (size_t i = 0; i < capacity; ++i) cells[i].sequence.store(i, std::memory_order_relaxed);
+        enqueuePos.store(0, std::memory_order_relaxed);
+        dequeuePos.store(0, std::memory_order_relaxed);
+    }
+
+    WasmMpmcQueue(const WasmMpmcQueue&) = delete;
+    WasmMpmcQueue& operator=(const WasmMpmcQueue&) = delete;
+
+    bool push(T&& value) {
+        Cell* cell;
+        size_t pos = enqueuePos.load(std::memory_order_relaxed);
+        while (true) {
+            cell = &cells[pos & mask];
+            size_t seq = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+            if (diff == 0) {
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                return false; // 满
+            } else {
+                pos = enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+        cell->data = std::move(value);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(T& value) {
+        Cell* cell;
+        size_t pos = dequeuePos.load(std::memory_order_relaxed);
+        while (true) {
+            cell = &cells[pos & mask];
+            size_t seq = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = (intptr_t)seq - (intptr_t)(pos + 1);
+            if (diff == 0) {
+                if (dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                return false; // 空
+            } else {
+                pos = dequeuePos.load(std::memory_order_relaxed);
+            }
+        }
+        value = std::move(cell->data);
+        cell->data = T();
+        cell->sequence.store(pos + mask + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 近似判空 (并发下仅作提示，用于决定是否进入休眠)
+    bool empty() const {
+        return enqueuePos.load(std::memory_order_acquire) == dequeuePos.load(std::memory_order_acquire);
+    }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T data;
+    };
+
+    // 生产者与消费者的位置分在不同缓存行，避免伪共享
+    alignas(64) const size_t mask;
+    std::unique_ptr<Cell[]> cells;
+    alignas(64) std::atomic<size_t> enqueuePos;
+    alignas(64) std::atomic<size_t> dequeuePos;
+};
+
+#endif //WASM_MPMC_QUEUE_H
\ No newline at end of file
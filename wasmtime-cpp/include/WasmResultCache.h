@@ -0,0 +1,75 @@
+#ifndef WASM_RESULT_CACHE_H
+#define WASM_RESULT_CACHE_H
+
+#include "WasmCommon.h"
+#include <atomic>
+#include <chrono>
+#include <list>
+#include <mutex>
+#include <set>
+#include <shared_mutex>
+#include <string_view>
+#include <unordered_map>
+
+/**
+ * 纯函数 action 的结果缓存 (LRU，默认关闭)
+ *
+ * 只有被声明为纯函数的 action 才会缓存: Host 通过 declarePure 配置，或 Guest 在初始化时调用 host_declare_pure 声明。
+ * 预初始化模块跳过 _initialize，Guest 需导出 __wasmline_declare_pure，在加载时重新声明。
+ * 键为 hash(action, json)，命中时还会比对原始 action / json，哈希碰撞不会返回错误结果。
+ * 错误结果 ({"error": ...}) 不缓存。容量按 action + json + 结果的字节数计算，超出后淘汰最久未用的条目。
+ */
+class WasmResultCache {
+public:
+    // maxBytes 为 0 表示关闭；ttlMs <= 0 表示不过期。重新配置会清空已有条目
+    void configure(size_t maxBytes, int64_t ttlMs = 0);
+    bool isEnabled() const { return enabled.load(std::memory_order_relaxed); }
+
+    void declarePure(std::string_view action);
+    bool isPure(std::string_view action) const;
+
+    // 命中时把结果写入 out 并返回 true
+    bool lookup(std::string_view action, std::string_view json, std::string& out);
+    void store(std::string_view action, std::string_view json, const std::string& result);
+    void clear();
+
+    uint64_t hits() const { return hitCount.load(std::memory_order_relaxed); }
+    uint64_t misses() const { return missCount.load(std::memory_order_relaxed); }
+    uint64_t evictions() const { return evictionCount.load(std::memory_order_relaxed); }
+    size_t bytes() const;
+    // {"enabled": ..., "hits": ..., "misses": ..., "evictions": ..., "entries": ..., "bytes": ...}
+    std::string statsJson() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Entry {
+        uint64_t key;
+        std::string action;
+        std::string json;
+        std::string result;
+        Clock::time_point expiresAt;
+        size_t size() const { return action.size() + json.size() + result.size() + sizeof(Entry); }
+    };
+
+    static uint64_t keyOf(std::string_view action, std::string_view json);
+    void evictLocked(); // 需持有 lock
+
+    std::atomic<bool> enabled{false};
+    size_t maxBytes = 0;
+    int64_t ttlMs = 0;
+
+    mutable std::mutex lock;
+    std::list<Entry> lru; // 表头为最近使用
+    std::unordered_map<uint64_t, std::list<Entry>::iterator> index;
+    size_t usedBytes = 0;
+
+    mutable std::shared_mutex pureLock;
+    std::set<std::string, std::less<>> pureActions;
+
+    std::atomic<uint64_t> hitCount{0};
+    std::atomic<uint64_t> missCount{0};
+    std::atomic<uint64_t> evictionCount{0};
+};
+
+#endif //WASM_RESULT_CACHE_H
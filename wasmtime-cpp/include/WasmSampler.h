@@ -0,0 +1,68 @@
+#ifndef WASM_SAMPLER_H
+#define WASM_SAMPLER_H
+
+#include "WasmCommon.h"
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+#include <string_view>
+
+/**
+ * 进程内采样 Profiler (不依赖 perf)
+ *
+ * 由 epoch 节拍驱动: 调用进行中时 WasmExecutor 的 epoch 回调每隔 interval 调用一次 sample，
+ * 按 action 聚合。每个 action 一个 Wasmtime GuestProfiler，采集带函数名的 Wasm 调用栈，导出 Firefox Profiler 格式；
+ * libwasmtime 未启用 profiling 特性时退化为只统计 "action;阶段" 的折叠栈计数。
+ * 折叠栈始终只有 "action;阶段" 两层: C API 只能从 Trap (wasm_trap_trace) 拿到 wasm_frame_t，
+ * epoch 回调里没有抓取当前调用栈的接口，Guest 帧只在 GuestProfiler 导出的 Firefox Profile 里。
+ * 采样粒度不低于 WasmEpochTicker 的节拍 (5ms)。
+ */
+class WasmSampler {
+public:
+    enum class Phase { Instantiate, Initialize, Run, Count };
+
+    // 实例化与 _initialize 不属于任何 action，统一记在这个名字下
+    static constexpr const char* kStartupAction = "_startup";
+    static constexpr size_t kMaxActions = 256;
+
+    WasmSampler(wasm_engine_t* engine, const wasmtime_module_t* module, int64_t intervalMs);
+    ~WasmSampler();
+
+    void setInterval(int64_t intervalMs) { intervalNs.store(intervalMs * 1000000, std::memory_order_relaxed); }
+    int64_t getIntervalNs() const { return intervalNs.load(std::memory_order_relaxed); }
+
+    // 在 epoch 回调里调用 (调用线程上，Store 正在执行 Wasm)；deltaNs 为距上次采样的时间
+    void sample(std::string_view action, Phase phase, wasmtime_store_t* store, uint64_t deltaNs);
+
+    // 折叠栈文本 ("action;phase 次数" 每行一条，不含 Guest 帧)，可直接交给 flamegraph.pl / inferno-flamegraph
+    std::string folded() const;
+    // 某个 action 的 Firefox Profiler JSON (https://profiler.firefox.com 打开)；导出后该 action 重新开始采集
+    // 不支持时返回 {"error": "..."}
+    std::string firefoxProfile(std::string_view action);
+    // 清空全部样本
+    void reset();
+
+private:
+    struct Entry {
+        std::string action;
+        std::mutex lock;
+        uint64_t counts[(int)Phase::Count] = {};
+#ifdef WASMTIME_FEATURE_PROFILING
+        wasmtime_guestprofiler_t* profiler = nullptr;
+#endif
+    };
+
+    Entry* findOrCreate(std::string_view action);
+    void restartProfiler(Entry& entry); // 需持有 entry.lock
+
+#ifdef WASMTIME_FEATURE_PROFILING
+    wasm_engine_t* engine = nullptr;
+    const wasmtime_module_t* module = nullptr;
+#endif
+    std::atomic<int64_t> intervalNs;
+
+    mutable std::shared_mutex lock;
+    std::vector<std::unique_ptr<Entry>> entries;
+};
+
+#endif //WASM_SAMPLER_H
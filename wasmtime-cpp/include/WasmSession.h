@@ -0,0 +1,42 @@
+#ifndef WASM_SESSION_H
+#define WASM_SESSION_H
+
+#include "WasmCommon.h"
+#include "WasmConfig.h"
+#include <mutex>
+
+class WasmModule;
+class WasmExecutor;
+class WasmCancelToken;
+
+/**
+ * 常驻会话: 持有一个 Store 和已初始化的 Instance
+ * _initialize (Kotlin 运行时启动 + initApp 路由注册) 只执行一次，
+ * 之后每次 call 只重置 action / json / output 缓冲区并调用 run_entry
+ *
+ * 注意: Session 不能比创建它的 WasmModule 活得更久
+ */
+class WasmSession {
+public:
+    ~WasmSession();
+
+    // 创建会话并完成实例化，失败返回 nullptr
+    // limits 约束整个会话生命周期内的 Store (会话内存会跨调用累积)，默认沿用模块的单次调用上限
+    static WasmSession* open(WasmModule* module);
+    static WasmSession* open(WasmModule* module, const WasmStoreLimits& limits);
+
+    // 执行调用 (内部加锁，同一会话的调用会被串行化)
+    // timeoutMs < 0 表示不限时；超时 / 取消后实例被丢弃，下次调用自动重建
+    std::string call(const std::string& action, const std::string& json, int64_t timeoutMs = -1,
+                     const std::shared_ptr<WasmCancelToken>& cancelToken = nullptr);
+
+private:
+    WasmSession(WasmModule* module, const WasmStoreLimits& limits);
+
+    WasmModule* holder;
+    WasmStoreLimits limits;
+    std::unique_ptr<WasmExecutor> executor;
+    std::mutex lock;
+};
+
+#endif //WASM_SESSION_H
\ No newline at end of file
@@ -0,0 +1,66 @@
+#ifndef WASM_STATS_H
+#define WASM_STATS_H
+
+#include "WasmCommon.h"
+#include <atomic>
+#include <chrono>
+
+// 计数器编号 (也是 WasmStatsSnapshot::values 与 JNI LongArray 的下标顺序)
+enum class WasmCounter : int {
+    StoreCreateNs,
+    StoreCreateCount,
+    InstantiateNs,
+    InstantiateCount,
+    InitializeNs,
+    InitializeCount,
+    RunNs,
+    RunCount,
+    HostCalls,
+    BytesIn,
+    BytesOut,
+    Count,
+};
+
+// 某一时刻各计数器的合计值
+struct WasmStatsSnapshot {
+    uint64_t values[(int)WasmCounter::Count] = {};
+
+    uint64_t get(WasmCounter counter) const { return values[(int)counter]; }
+    std::string toJson() const;
+};
+
+/**
+ * 模块级执行计数器 (常开)
+ *
+ * 按线程分片: 每个线程固定落在一个分片上，分片独占缓存行，
+ * 并发调用之间只做 relaxed 原子加，不会互相争用同一缓存行。读取时把所有分片相加。
+ */
+class WasmStats {
+public:
+    static constexpr int kShards = 16;
+
+    void add(WasmCounter counter, uint64_t value) {
+        shards[shardIndex()].values[(int)counter].fetch_add(value, std::memory_order_relaxed);
+    }
+
+    // 记录一个阶段: 累加耗时 (ns) 与次数
+    void addPhase(WasmCounter nsCounter, std::chrono::steady_clock::time_point start) {
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+        Shard& shard = shards[shardIndex()];
+        shard.values[(int)nsCounter].fetch_add((uint64_t)ns.count(), std::memory_order_relaxed);
+        shard.values[(int)nsCounter + 1].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    WasmStatsSnapshot snapshot() const;
+    void reset();
+
+private:
+    struct alignas(64) Shard {
+        std::atomic<uint64_t> values[(int)WasmCounter::Count] = {};
+    };
+    Shard shards[kShards];
+
+    static int shardIndex();
+};
+
+#endif //WASM_STATS_H
@@ -0,0 +1,66 @@
+#ifndef WASM_WASI_POLICY_H
+#define WASM_WASI_POLICY_H
+
+#include "WasmCommon.h"
+
+struct WasmLogTarget;
+
+/**
+ * 模块级 WASI 策略模板: 环境变量白名单、argv、预打开目录与标准输出去向
+ *
+ * 策略在模块上定义一次，环境变量白名单在设置时就解析成名值对并展平成 C 字符串数组，
+ * 每次调用只需把这些数组交给 wasi_config_t (Wasmtime 的 wasi_config_t 由 Store 接管，无法跨 Store 复用)。
+ * 默认策略不暴露任何宿主环境变量，不再把整个进程环境拷进每个 Store。
+ */
+class WasmWasiPolicy {
+public:
+    // Guest stdout / stderr 的去向
+    enum class Stdio {
+        LogSink, // 异步日志队列 (WasmLogSink)，受模块日志策略约束
+        Inherit, // 直接写宿主进程的 stdout / stderr
+        Discard, // 丢弃
+    };
+
+    struct Preopen {
+        std::string hostPath;
+        std::string guestPath;
+        bool readOnly = true;
+    };
+
+    // 显式设置一个环境变量 (同名覆盖)
+    WasmWasiPolicy& setEnv(const std::string& name, const std::string& value);
+    // 白名单: 从当前进程环境中复制这些变量 (设置时读取一次，之后宿主环境的变化不会反映到 Guest)
+    WasmWasiPolicy& allowEnv(const std::vector<std::string>& names);
+    WasmWasiPolicy& setArgs(const std::vector<std::string>& args);
+    WasmWasiPolicy& addPreopen(const std::string& hostPath, const std::string& guestPath, bool readOnly = true);
+    WasmWasiPolicy& setStdio(Stdio value) { stdio = value; return *this; }
+
+    // 为一个新 Store 生成 WASI 配置 (所有权交给调用方，通常直接交给 wasmtime_context_set_wasi)
+    // 预打开目录失败时返回 nullptr (调用方不能在没有 WASI 上下文的 Store 上运行导入了 WASI 的模块)
+    wasi_config_t* build(WasmLogTarget* logTarget) const;
+
+    const std::vector<std::pair<std::string, std::string>>& getEnv() const { return env; }
+    const std::vector<std::string>& getArgs() const { return args; }
+    const std::vector<Preopen>& getPreopens() const { return preopens; }
+    Stdio getStdio() const { return stdio; }
+
+    // 拷贝时重建指针数组，使其指向新对象自己的字符串
+    WasmWasiPolicy() = default;
+    WasmWasiPolicy(const WasmWasiPolicy& other);
+    WasmWasiPolicy& operator=(const WasmWasiPolicy& other);
+
+private:
+    void flatten(); // 重新生成 envNames / envValues / argv
+
+    std::vector<std::pair<std::string, std::string>> env;
+    std::vector<std::string> args;
+    std::vector<Preopen> preopens;
+    Stdio stdio = Stdio::LogSink;
+
+    // 展平后的 C 字符串数组，指向 env / args 中的字符串
+    std::vector<const char*> envNames;
+    std::vector<const char*> envValues;
+    std::vector<const char*> argv;
+};
+
+#endif //WASM_WASI_POLICY_H
@@ -0,0 +1,44 @@
+#ifndef WASM_WORKER_POOL_H
+#define WASM_WORKER_POOL_H
+
+#include "WasmCommon.h"
+#include "WasmMpmcQueue.h"
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+
+/**
+ * Native 调用线程池
+ *
+ * 线程数固定为 CPU 核数，提交走无锁 MPMC 队列；队列为空时工作线程休眠，不空转。
+ * 每个任务在工作线程上创建并销毁自己的 Store，Store 从不跨线程共享。
+ * 线程池随进程常驻，不提供关闭。
+ */
+class WasmWorkerPool {
+public:
+    using Task = std::function<void()>;
+
+    // 进程级共享线程池 (首次使用时创建)
+    static WasmWorkerPool& shared();
+
+    // 提交任务；队列已满时返回 false，任务不会执行
+    bool submit(Task task);
+
+    size_t size() const { return threadCount; }
+
+    // 当前线程是否为线程池的工作线程 (在工作线程上同步等待池内任务可能自锁)
+    static bool isWorkerThread();
+
+private:
+    WasmWorkerPool(size_t threads, size_t capacity);
+    void workerLoop();
+
+    WasmMpmcQueue<Task> queue;
+    size_t threadCount;
+
+    // 仅用于空闲时休眠 / 唤醒，提交与取任务本身不加锁
+    std::mutex sleepLock;
+    std::condition_variable wakeup;
+};
+
+#endif //WASM_WORKER_POOL_H
\ No newline at end of file
@@ -1,5 +1,10 @@
 #include "JniUtils.h"
 #include <fstream>
+#include <cstdlib>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
 #include <sys/stat.h>
 
 namespace JniUtils {
@@ -9,6 +14,12 @@ namespace JniUtils {
         return (stat(path.c_str(), &buffer) == 0);
     }
 
+    int64_t fileSize(const std::string& path) {
+        struct stat buffer;
+        if (stat(path.c_str(), &buffer) != 0) return -1;
+        return (int64_t)buffer.st_size;
+    }
+
     std::vector<uint8_t> readFile(const std::string& path) {
         std::ifstream file(path, std::ios::binary);
         if (!file) return {};
@@ -31,6 +42,69 @@ namespace JniUtils {
         std::ofstream file(path, std::ios::binary);
         if (!file) return false;
         file.write((const char*)data.data(), data.size());
+        return file.good();
+    }
+
+    static bool fail(std::string* error, const std::string& what, int fd = -1) {
+        int code = errno;
+        if (fd >= 0) close(fd);
+        if (error) *error = what + ": " + strerror(code);
+        return false;
+    }
+
+    bool writeFileAtomic(const std::string& path, const uint8_t* data, size_t size, std::string* error) {
+        // 临时文件与目标同目录，保证 rename 是同一文件系统内的原子操作
+        // 文件名由 mkostemp 生成且独占创建: 同一进程内多个线程并发写同一路径 (后台缓存写入、重复 loadAsync、
+        // 同步 saveCacheToPath) 各写各的临时文件，最后一个 rename 的完整文件胜出，内容不会交错
+        std::string tmp = path + ".tmp.XXXXXX";
+
+        int fd = mkostemp(&tmp[0], O_CLOEXEC);
+        if (fd < 0) return fail(error, "mkostemp " + tmp);
+        // mkostemp 固定以 0600 创建，与普通缓存文件保持一致的权限
+        if (fchmod(fd, 0644) != 0) {
+            fail(error, "fchmod " + tmp, fd);
+            unlink(tmp.c_str());
+            return false;
+        }
+
+        // 处理短写和 EINTR
+        size_t written = 0;
+        while (written < size) {
+            ssize_t n = write(fd, data + written, size - written);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                fail(error, "write " + tmp, fd);
+                unlink(tmp.c_str());
+                return false;
+            }
+            written += (size_t)n;
+        }
+
+        if (fsync(fd) != 0) {
+            fail(error, "fsync " + tmp, fd);
+            unlink(tmp.c_str());
+            return false;
+        }
+        if (close(fd) != 0) {
+            fail(error, "close " + tmp);
+            unlink(tmp.c_str());
+            return false;
+        }
+
+        if (rename(tmp.c_str(), path.c_str()) != 0) {
+            fail(error, "rename " + tmp);
+            unlink(tmp.c_str());
+            return false;
+        }
+
+        // 持久化目录项，避免掉电后 rename 丢失
+        auto slash = path.find_last_of('/');
+        std::string dir = slash == std::string::npos ? "." : (slash == 0 ? "/" : path.substr(0, slash));
+        int dirFd = open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (dirFd >= 0) {
+            fsync(dirFd);
+            close(dirFd);
+        }
         return true;
     }
 
@@ -1,26 +1,235 @@
 #include "WasmConfig.h"
+#include "WasmModuleCache.h"
+#include <cstdlib>
 
-wasm_config_t* WasmConfig::createAndroidConfig() {
-    wasm_config_t* conf = wasm_config_new();
+#ifndef WASMTIME_VERSION
+#define WASMTIME_VERSION "unknown"
+#endif
+
+WasmConfig WasmConfig::androidSafe() {
+    WasmConfig c;
+    c.name = "android-safe";
 
     // 1. 开启高级特性
-    wasmtime_config_wasm_gc_set(conf, true);
-    wasmtime_config_wasm_function_references_set(conf, true);
-    wasmtime_config_wasm_exceptions_set(conf, true);
+    c.gc = true;
+    c.functionReferences = true;
+    c.exceptions = true;
 
     // 2. Android 兼容性配置 (至关重要)
     // 关闭 SIMD: 防止指令集不兼容
-    wasmtime_config_wasm_simd_set(conf, false);
-    wasmtime_config_wasm_relaxed_simd_set(conf, false);
+    c.simd = false;
+    c.relaxedSimd = false;
 
-    // 关闭信号 Trap: 这一步决定了必须在本地编译，不能用编译的文件
-    wasmtime_config_signals_based_traps_set(conf, false);
+    // 关闭信号 Trap: 避免与 ART 虚拟机的信号处理冲突，改用显式边界检查
+    c.signalsBasedTraps = false;
 
     // 内存页保护设为 0: 适配 Android 虚拟内存机制
-    wasmtime_config_memory_guard_size_set(conf, 0);
+    c.memoryGuardSize = 0;
 
     // 限制栈大小 (512KB)
-    wasmtime_config_max_wasm_stack_set(conf, 512 * 1024);
+    c.maxWasmStack = 512 * 1024;
+
+    // 不插入 epoch 检查: 大多数调用不设截止时间，不为用不到的中断能力付出每个函数 / 循环的检查开销
+    c.epochInterruption = false;
+    return c;
+}
+
+WasmConfig WasmConfig::androidInterruptible() {
+    WasmConfig c = androidSafe();
+    c.name = "android-interruptible";
+    // 需要超时 / 协程取消 / 采样 Profiler 时选用，代价是 epoch 检查
+    c.epochInterruption = true;
+    return c;
+}
+
+WasmConfig WasmConfig::linuxServerFast() {
+    WasmConfig c;
+    c.name = "linux-server-fast";
+    c.gc = true;
+    c.functionReferences = true;
+    c.exceptions = true;
+
+    // 服务器 CPU 指令集可控，开启向量指令
+    c.simd = true;
+    c.relaxedSimd = true;
+
+    // 信号 Trap + 默认的大块内存预留与保护页: 省掉显式边界检查
+    c.signalsBasedTraps = true;
+    c.memoryGuardSize = -1;
+    c.memoryReservation = -1;
+
+    c.optLevel = WASMTIME_OPT_LEVEL_SPEED;
+    c.parallelCompilation = true;
+    c.maxWasmStack = 1024 * 1024;
+
+    // 服务端需要限时调用来保护尾延迟
+    c.epochInterruption = true;
+
+    // 高并发下每次调用都新建 Store，改用 Pooling 复用槽位，消除 mmap / munmap 抖动
+    // 每个内存槽位按默认 4GiB 预留虚拟地址，256 个槽位约 1TiB，64 位 Linux 上没有压力
+    c.pooling.enabled = true;
+    c.pooling.totalInstances = 256;
+    c.pooling.totalMemories = 256;
+    c.pooling.totalTables = 256;
+    c.pooling.totalGcHeaps = 256;
+    c.pooling.maxMemorySize = 256 * 1024 * 1024;
+    c.pooling.maxUnusedWarmSlots = 64;
+    c.pooling.keepResident = 64 * 1024;
+    return c;
+}
+
+WasmConfig WasmConfig::fastStartup() {
+    WasmConfig c = androidSafe();
+    c.name = "fast-startup";
+    // 不做优化，编译最快，执行稍慢
+    c.optLevel = WASMTIME_OPT_LEVEL_NONE;
+    c.parallelCompilation = true;
+    return c;
+}
+
+WasmConfig WasmConfig::defaultProfile() {
+#ifdef __ANDROID__
+    return androidSafe();
+#else
+    return linuxServerFast();
+#endif
+}
+
+bool WasmConfig::fromName(const std::string& profile, WasmConfig& out) {
+    if (profile.empty() || profile == "default") out = defaultProfile();
+    else if (profile == "android-safe") out = androidSafe();
+    else if (profile == "android-interruptible") out = androidInterruptible();
+    else if (profile == "linux-server-fast") out = linuxServerFast();
+    else if (profile == "fast-startup") out = fastStartup();
+    else return false;
+    return true;
+}
+
+wasm_config_t* WasmConfig::build() const {
+    wasm_config_t* conf = wasm_config_new();
+
+    wasmtime_config_wasm_gc_set(conf, gc);
+    wasmtime_config_wasm_function_references_set(conf, functionReferences);
+    wasmtime_config_wasm_exceptions_set(conf, exceptions);
+    wasmtime_config_wasm_simd_set(conf, simd);
+    wasmtime_config_wasm_relaxed_simd_set(conf, relaxedSimd);
+
+    wasmtime_config_cranelift_opt_level_set(conf, optLevel);
+    wasmtime_config_parallel_compilation_set(conf, parallelCompilation);
+
+    wasmtime_config_signals_based_traps_set(conf, signalsBasedTraps);
+    if (memoryGuardSize >= 0) wasmtime_config_memory_guard_size_set(conf, (uint64_t)memoryGuardSize);
+    if (memoryReservation >= 0) wasmtime_config_memory_reservation_set(conf, (uint64_t)memoryReservation);
+    if (maxWasmStack > 0) wasmtime_config_max_wasm_stack_set(conf, maxWasmStack);
+
+    wasmtime_config_epoch_interruption_set(conf, epochInterruption);
+
+    if (pooling.enabled) {
+#ifdef WASMTIME_FEATURE_POOLING_ALLOCATOR
+        wasmtime_pooling_allocation_config_t* pool = wasmtime_pooling_allocation_config_new();
+        if (pooling.totalInstances) wasmtime_pooling_allocation_config_total_core_instances_set(pool, pooling.totalInstances);
+        if (pooling.totalMemories) wasmtime_pooling_allocation_config_total_memories_set(pool, pooling.totalMemories);
+        if (pooling.totalTables) wasmtime_pooling_allocation_config_total_tables_set(pool, pooling.totalTables);
+        if (pooling.totalGcHeaps) wasmtime_pooling_allocation_config_total_gc_heaps_set(pool, pooling.totalGcHeaps);
+        if (pooling.maxMemorySize) wasmtime_pooling_allocation_config_max_memory_size_set(pool, pooling.maxMemorySize);
+        if (pooling.tableElements) wasmtime_pooling_allocation_config_table_elements_set(pool, pooling.tableElements);
+        if (pooling.maxUnusedWarmSlots) wasmtime_pooling_allocation_config_max_unused_warm_slots_set(pool, pooling.maxUnusedWarmSlots);
+        if (pooling.keepResident) wasmtime_pooling_allocation_config_linear_memory_keep_resident_set(pool, pooling.keepResident);
+        // Config 内部拷贝一份，这里可以直接释放
+        wasmtime_pooling_allocation_strategy_set(conf, pool);
+        wasmtime_pooling_allocation_config_delete(pool);
+#else
+        LOGE("Pooling allocator requested but libwasmtime was built without it, using on-demand allocator");
+#endif
+    }
+
+    wasmtime_config_debug_info_set(conf, debugInfo);
+    wasmtime_config_native_unwind_info_set(conf, nativeUnwindInfo);
+
+    switch (getProfiler()) {
+        case WasmProfiler::PerfMap: wasmtime_config_profiler_set(conf, WASMTIME_PROFILING_STRATEGY_PERFMAP); break;
+        case WasmProfiler::JitDump: wasmtime_config_profiler_set(conf, WASMTIME_PROFILING_STRATEGY_JITDUMP); break;
+        case WasmProfiler::VTune: wasmtime_config_profiler_set(conf, WASMTIME_PROFILING_STRATEGY_VTUNE); break;
+        case WasmProfiler::None: break;
+    }
 
     return conf;
+}
+
+std::string WasmConfig::describeCode() const {
+    std::string desc = "gc=" + std::to_string(gc);
+    desc += ";function-references=" + std::to_string(functionReferences);
+    desc += ";exceptions=" + std::to_string(exceptions);
+    desc += ";simd=" + std::to_string(simd);
+    desc += ";relaxed-simd=" + std::to_string(relaxedSimd);
+    desc += ";opt-level=" + std::to_string((int)optLevel);
+    desc += ";parallel-compilation=" + std::to_string(parallelCompilation);
+    desc += ";signals-based-traps=" + std::to_string(signalsBasedTraps);
+    desc += ";memory-guard-size=" + std::to_string(memoryGuardSize);
+    desc += ";memory-reservation=" + std::to_string(memoryReservation);
+    desc += ";max-wasm-stack=" + std::to_string(maxWasmStack);
+    desc += ";epoch-interruption=" + std::to_string(epochInterruption);
+    desc += ";pooling=" + std::to_string(pooling.enabled);
+    if (pooling.enabled) {
+        desc += ";pool-instances=" + std::to_string(pooling.totalInstances);
+        desc += ";pool-memories=" + std::to_string(pooling.totalMemories);
+        desc += ";pool-tables=" + std::to_string(pooling.totalTables);
+        desc += ";pool-gc-heaps=" + std::to_string(pooling.totalGcHeaps);
+        desc += ";pool-max-memory=" + std::to_string(pooling.maxMemorySize);
+        desc += ";pool-table-elements=" + std::to_string(pooling.tableElements);
+        desc += ";pool-warm-slots=" + std::to_string(pooling.maxUnusedWarmSlots);
+        desc += ";pool-keep-resident=" + std::to_string(pooling.keepResident);
+    }
+    desc += ";debug-info=" + std::to_string(debugInfo);
+    desc += ";native-unwind-info=" + std::to_string(nativeUnwindInfo);
+    return desc;
+}
+
+static const char* profilerName(WasmProfiler profiler) {
+    switch (profiler) {
+        case WasmProfiler::PerfMap: return "perfmap";
+        case WasmProfiler::JitDump: return "jitdump";
+        case WasmProfiler::VTune: return "vtune";
+        default: return "none";
+    }
+}
+
+std::string WasmConfig::describe() const {
+    return name + "(" + describeCode() + ";profiler=" + profilerName(getProfiler()) + ")";
+}
+
+bool WasmConfig::profilerFromName(const std::string& value, WasmProfiler& out) {
+    if (value.empty() || value == "none") out = WasmProfiler::None;
+    else if (value == "perfmap") out = WasmProfiler::PerfMap;
+    else if (value == "jitdump") out = WasmProfiler::JitDump;
+    else if (value == "vtune") out = WasmProfiler::VTune;
+    else return false;
+    return true;
+}
+
+WasmProfiler WasmConfig::getProfiler() const {
+    const char* env = getenv("WASMLINE_PROFILER");
+    if (!env) return profiler;
+    WasmProfiler fromEnv;
+    if (!profilerFromName(env, fromEnv)) {
+        LOGE("Unknown WASMLINE_PROFILER=%s, ignored", env);
+        return profiler;
+    }
+    return fromEnv;
+}
+
+uint64_t WasmConfig::fingerprint() const {
+    // 名字不参与指纹: 内容相同的配置即可共享缓存 (格式与旧版一致，已有的 .cwasm 不会失效)
+    std::string desc = "wasmtime=" WASMTIME_VERSION ";(" + describeCode() + ")";
+    return WasmModuleCache::hashBytes(desc.data(), desc.size());
+}
+
+uint64_t WasmConfig::engineKey() const {
+    // Profiler 只决定 JIT 代码注册到哪里，不改变编译产物
+    std::string desc = "wasmtime=" WASMTIME_VERSION ";(" + describeCode() + ");profiler=" + profilerName(getProfiler());
+    return WasmModuleCache::hashBytes(desc.data(), desc.size());
+}
+
+wasm_config_t* WasmConfig::createAndroidConfig() {
+    return androidSafe().build();
 }
\ No newline at end of file
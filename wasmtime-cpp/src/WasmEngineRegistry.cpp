@@ -0,0 +1,60 @@
+#include "WasmEngineRegistry.h"
+#include "WasmEpochTicker.h"
+#include "WasmExecutor.h"
+#include <mutex>
+#include <unordered_map>
+
+namespace {
+    struct EngineEntry {
+        wasm_engine_t* engine = nullptr;
+        wasmtime_linker_t* linker = nullptr;
+    };
+
+    std::mutex g_lock;
+    std::unordered_map<uint64_t, EngineEntry> g_engines;
+}
+
+wasm_engine_t* WasmEngineRegistry::acquire(const WasmConfig& config) {
+    uint64_t fp = config.engineKey();
+
+    std::lock_guard<std::mutex> guard(g_lock);
+    auto it = g_engines.find(fp);
+    if (it != g_engines.end()) return it->second.engine;
+
+    // Engine 会接管 Config 的所有权
+    wasm_engine_t* engine = wasm_engine_new_with_config(config.build());
+    if (!engine) {
+        LOGE("FATAL: Failed to create wasm engine: %s", config.describe().c_str());
+        return nullptr;
+    }
+    g_engines[fp].engine = engine;
+    if (config.hasEpochInterruption()) WasmEpochTicker::registerEngine(engine);
+    LOGI("Wasm Engine initialized: %s", config.describe().c_str());
+    return engine;
+}
+
+wasmtime_linker_t* WasmEngineRegistry::sharedLinker(wasm_engine_t* engine) {
+    std::lock_guard<std::mutex> guard(g_lock);
+    for (auto& [fp, entry] : g_engines) {
+        if (entry.engine != engine) continue;
+        if (!entry.linker) {
+            entry.linker = createBaseLinker(engine);
+            LOGI("Shared Wasm Linker initialized.");
+        }
+        return entry.linker;
+    }
+    LOGE("Engine is not registered");
+    return nullptr;
+}
+
+wasmtime_linker_t* WasmEngineRegistry::createBaseLinker(wasm_engine_t* engine) {
+    wasmtime_linker_t* linker = wasmtime_linker_new(engine);
+    wasmtime_error_t* err = wasmtime_linker_define_wasi(linker);
+    if (err) {
+        LOGE("Define WASI failed");
+        wasmtime_error_delete(err);
+    }
+    // 具体的函数注册逻辑交给 Executor 处理
+    WasmExecutor::registerHostFunctions(linker);
+    return linker;
+}
\ No newline at end of file
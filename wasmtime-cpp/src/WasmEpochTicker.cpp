@@ -0,0 +1,53 @@
+#include "WasmEpochTicker.h"
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace {
+    std::mutex g_lock;
+    std::condition_variable g_cond;
+    std::vector<wasm_engine_t*> g_engines;
+    int g_active = 0;
+    bool g_started = false;
+
+    void tickLoop() {
+        std::unique_lock<std::mutex> guard(g_lock);
+        while (true) {
+            // 没有限时调用时挂起，直到有人 acquire
+            g_cond.wait(guard, [] { return g_active > 0; });
+            guard.unlock();
+            std::this_thread::sleep_for(std::chrono::milliseconds(WasmEpochTicker::kTickMs));
+            guard.lock();
+            // Engine 常驻进程 (注册表从不释放)，这里可以安全访问
+            for (auto* engine : g_engines) wasmtime_engine_increment_epoch(engine);
+        }
+    }
+}
+
+void WasmEpochTicker::registerEngine(wasm_engine_t* engine) {
+    std::lock_guard<std::mutex> guard(g_lock);
+    g_engines.push_back(engine);
+}
+
+void WasmEpochTicker::acquire() {
+    {
+        std::lock_guard<std::mutex> guard(g_lock);
+        ++g_active;
+        if (!g_started) {
+            try {
+                std::thread(tickLoop).detach();
+                g_started = true;
+                LOGI("Epoch ticker started (tick=%lldms)", (long long)kTickMs);
+            } catch (const std::system_error& e) {
+                LOGE("Failed to start epoch ticker: %s", e.what());
+            }
+        }
+    }
+    g_cond.notify_one();
+}
+
+void WasmEpochTicker::release() {
+    std::lock_guard<std::mutex> guard(g_lock);
+    --g_active;
+}
\ No newline at end of file
@@ -1,96 +1,337 @@
 #include "WasmExecutor.h"
 #include "WasmModule.h"
+#include "WasmEpochTicker.h"
 #include <cstring>
 
-// 日志回调
-static ptrdiff_t wasi_write_cb(void* data, const unsigned char* buffer, size_t size) {
-    if (size == 0 || !buffer) return 0;
-    size_t print_size = size > 4096 ? 4096 : size;
-    std::string msg((const char*)buffer, print_size);
-    while (!msg.empty() && (msg.back() == '\n' || msg.back() == '\r')) msg.pop_back();
-    if (!msg.empty()) LOGI("[WASI] %s", msg.c_str());
-    return size;
-}
+WasmExecutor::WasmExecutor(WasmModule* m) : WasmExecutor(m, m->getCallConfig(), nullptr) {}
+
+WasmExecutor::WasmExecutor(WasmModule* m, const WasmStoreLimits& l) : WasmExecutor(m, m->getCallConfig(), &l) {}
+
+WasmExecutor::WasmExecutor(WasmModule* m, std::shared_ptr<const WasmCallConfig> config, const WasmStoreLimits* l)
+        : holder(m), callConfig(std::move(config)), limits(l ? *l : callConfig->limits) {
+    logTarget.policy = &holder->getLogPolicy();
+    logTarget.setTag(callConfig->logTag);
+    auto start = std::chrono::steady_clock::now();
 
-WasmExecutor::WasmExecutor(WasmModule* m, std::string a, std::string j)
-    : holder(m), inputAction(std::move(a)), inputJson(std::move(j)) {
-    
     // Store 的 data 设置为 this，以便 static callback 获取实例
     store = wasmtime_store_new(holder->getEngine(), this, nullptr);
     context = wasmtime_store_context(store);
 
-    wasi_config_t* wasi = wasi_config_new();
-    wasi_config_inherit_env(wasi);
-    wasi_config_set_stdout_custom(wasi, wasi_write_cb, nullptr, nullptr);
-    wasi_config_set_stderr_custom(wasi, wasi_write_cb, nullptr, nullptr);
-    wasmtime_context_set_wasi(context, wasi);
+    // WASI 上下文按模块策略生成；未导入 WASI 的模块不建立 WASI 上下文
+    // 建立失败时不能继续运行: Linker 中的 WASI 函数假定上下文存在，首次 fd_write / proc_exit 就会在 wasmtime 内部 panic
+    if (holder->isUsingWasi()) {
+        wasi_config_t* wasi = callConfig->wasi->build(&logTarget);
+        if (!wasi) {
+            setupError = "{\"error\": \"WASI Setup Failed\", \"reason\": \"preopen\"}";
+        } else if (wasmtime_error_t* err = wasmtime_context_set_wasi(context, wasi)) {
+            wasm_byte_vec_t msg;
+            wasmtime_error_message(err, &msg);
+            LOGE("WASI setup failed: %.*s", (int)msg.size, msg.data);
+            wasm_byte_vec_delete(&msg);
+            wasmtime_error_delete(err);
+            setupError = "{\"error\": \"WASI Setup Failed\", \"reason\": \"context\"}";
+        }
+    }
+
+    if (limits.isLimited()) {
+        wasmtime_store_limiter(store, limits.memorySize, limits.tableElements, limits.instances, limits.tables,
+                               limits.memories);
+    }
+
+    // 启用 epoch 中断后每个 Store 都必须有截止值，默认不限时
+    if (holder->hasEpochInterruption()) {
+        wasmtime_context_set_epoch_deadline(context, WasmEpochTicker::kNoDeadline);
+        wasmtime_store_epoch_deadline_callback(store, epoch_callback, this, nullptr);
+    }
+    holder->getCounters().addPhase(WasmCounter::StoreCreateNs, start);
 }
 
 WasmExecutor::~WasmExecutor() {
     if (store) wasmtime_store_delete(store);
 }
 
+bool WasmExecutor::defineFunction(wasmtime_linker_t* linker, const std::string& moduleName, const std::string& name,
+                                  wasmtime_func_callback_t callback,
+                                  const std::vector<wasm_valkind_t>& params, const std::vector<wasm_valkind_t>& results,
+                                  void* env) {
+    wasm_valtype_vec_t p, r;
+    std::vector<wasm_valtype_t*> vp, vr;
+    for(auto k:params) vp.push_back(wasm_valtype_new(k));
+    for(auto k:results) vr.push_back(wasm_valtype_new(k));
+    wasm_valtype_vec_new(&p, vp.size(), vp.data());
+    wasm_valtype_vec_new(&r, vr.size(), vr.data());
+    wasm_functype_t* ty = wasm_functype_new(&p, &r);
+    wasmtime_error_t* err = wasmtime_linker_define_func(linker, moduleName.data(), moduleName.size(),
+                                                        name.data(), name.size(), ty, callback, env, nullptr);
+    wasm_functype_delete(ty);
+    if (err) {
+        wasm_byte_vec_t msg;
+        wasmtime_error_message(err, &msg);
+        LOGE("Define %s.%s failed: %s", moduleName.c_str(), name.c_str(), msg.data);
+        wasm_byte_vec_delete(&msg);
+        wasmtime_error_delete(err);
+        return false;
+    }
+    return true;
+}
+
 void WasmExecutor::registerHostFunctions(wasmtime_linker_t* linker) {
-    auto def = [&](const char* name, wasmtime_func_callback_t cb, 
+    auto def = [&](const char* name, wasmtime_func_callback_t cb,
                    std::vector<wasm_valkind_t> p, std::vector<wasm_valkind_t> r) {
-        wasm_valtype_vec_t params, results;
-        std::vector<wasm_valtype_t*> vp, vr;
-        for(auto k:p) vp.push_back(wasm_valtype_new(k));
-        for(auto k:r) vr.push_back(wasm_valtype_new(k));
-        wasm_valtype_vec_new(&params, vp.size(), vp.data());
-        wasm_valtype_vec_new(&results, vr.size(), vr.data());
-        wasm_functype_t* ty = wasm_functype_new(&params, &results);
-        wasmtime_linker_define_func(linker, "env", 3, name, strlen(name), ty, cb, nullptr, nullptr);
-        wasm_functype_delete(ty);
+        defineFunction(linker, "env", name, cb, p, r);
     };
 
     def("host_get_action_size", host_get_action_size, {}, {WASM_I32});
     def("host_get_json_size", host_get_json_size, {}, {WASM_I32});
     def("host_read_input_byte", host_read_input_byte, {WASM_I32, WASM_I32}, {WASM_I32});
     def("host_write_result_byte", host_write_result_byte, {WASM_I32}, {});
+    def("host_read_input", host_read_input, {WASM_I32, WASM_I32, WASM_I32}, {WASM_I32});
+    def("host_write_result", host_write_result, {WASM_I32, WASM_I32}, {});
+    def("host_declare_pure", host_declare_pure, {WASM_I32, WASM_I32}, {});
 }
 
-std::string WasmExecutor::run() {
-    wasmtime_instance_t instance;
+bool WasmExecutor::instantiate(std::string& error) {
+    if (instantiated) return true;
+    if (!setupError.empty()) {
+        error = setupError;
+        return false;
+    }
+    if (!holder->getInstancePre()) {
+        error = "{\"error\": \"Unresolved Imports\"}";
+        return false;
+    }
+    WasmStats& counters = holder->getCounters();
     wasm_trap_t* trap = nullptr;
+    bool armed = armDeadline();
 
-    // 1. Instantiate
-    wasmtime_error_t* err = wasmtime_linker_instantiate(holder->getLinker(), context, holder->getModule(), &instance, &trap);
+    // 1. Instantiate (从预链接模板实例化，不再重复解析导入)
+    samplePhase = WasmSampler::Phase::Instantiate;
+    auto start = std::chrono::steady_clock::now();
+    wasmtime_error_t* err = wasmtime_instance_pre_instantiate(holder->getInstancePre(), context, &instance, &trap);
+    counters.addPhase(WasmCounter::InstantiateNs, start);
     if (err || trap) {
-        LOGE("Instantiate failed");
-        if(err) wasmtime_error_delete(err);
-        if(trap) wasm_trap_delete(trap);
-        return "{\"error\": \"Instantiate Failed\"}";
+        disarmDeadline(armed);
+        // 启用 Pooling 时，槽位耗尽 (同时存活的实例过多) 也会走到这里
+        // 初始内存 / 表超出 Store 上限时同样在这里失败，错误信息见日志
+        std::string failure = describeFailure("Instantiate", err, trap);
+        error = interrupt != Interrupt::None ? failure : "{\"error\": \"Instantiate Failed\"}";
+        return false;
     }
+    hasInstance = true;
 
-    // 2. _initialize
+    // 2. _initialize (预初始化快照已固化了初始化结果，跳过)
     wasmtime_extern_t init_ext;
-    if (wasmtime_instance_export_get(context, &instance, "_initialize", 11, &init_ext)) {
-        wasmtime_func_call(context, &init_ext.of.func, nullptr, 0, nullptr, 0, &trap);
-        if (trap) {
-            LOGE("Init trap caught (could be normal exit)");
-            wasm_trap_delete(trap);
-            trap = nullptr;
+    if (!holder->isPreInitialized() && wasmtime_instance_export_get(context, &instance, "_initialize", 11, &init_ext)) {
+        samplePhase = WasmSampler::Phase::Initialize;
+        start = std::chrono::steady_clock::now();
+        hostCalls = 0;
+        err = wasmtime_func_call(context, &init_ext.of.func, nullptr, 0, nullptr, 0, &trap);
+        counters.addPhase(WasmCounter::InitializeNs, start);
+        if (hostCalls > 0) counters.add(WasmCounter::HostCalls, hostCalls);
+        if (err || trap) {
+            std::string failure = describeFailure("Init", err, trap);
+            // 超时 / 取消必须上报；其他 Trap 可能只是正常退出，沿用原来的忽略策略
+            if (interrupt != Interrupt::None) {
+                disarmDeadline(armed);
+                error = failure;
+                return false;
+            }
+            poisoned = false;
         }
     }
+    disarmDeadline(armed);
 
-    // 3. run_entry
+    // 3. 缓存 run_entry，后续 dispatch 不再查找导出
     wasmtime_extern_t run_ext;
-    if (wasmtime_instance_export_get(context, &instance, "run_entry", 9, &run_ext)) {
-        wasmtime_func_call(context, &run_ext.of.func, nullptr, 0, nullptr, 0, &trap);
-        if (trap) {
-            wasm_byte_vec_t msg;
-            wasm_trap_message(trap, &msg);
-            LOGE("Run trap: %s", msg.data);
-            wasm_byte_vec_delete(&msg);
-            wasm_trap_delete(trap);
-            return "{\"error\": \"Run Trap\"}";
-        }
-    } else {
-        return "{\"error\": \"Export run_entry not found\"}";
+    if (!wasmtime_instance_export_get(context, &instance, "run_entry", 9, &run_ext)) {
+        error = "{\"error\": \"Export run_entry not found\"}";
+        return false;
+    }
+    runEntry = run_ext.of.func;
+    instantiated = true;
+    return true;
+}
+
+void WasmExecutor::dispatch(std::string_view action, std::string_view json, std::string& out) {
+    out.clear();
+    if (!instantiated) {
+        out = setupError.empty() ? "{\"error\": \"Not Instantiated\"}" : setupError;
+        return;
+    }
+
+    // 只重置缓冲区: 输入指向调用方内存，输出直接写入 out (clear 保留已分配的容量)
+    inputAction = action;
+    inputJson = json;
+    outputResult = &out;
+
+    wasm_trap_t* trap = nullptr;
+    samplePhase = WasmSampler::Phase::Run;
+    size_t memoryBefore = limits.memorySize >= 0 ? linearMemorySize() : 0;
+    bool armed = armDeadline();
+    hostCalls = 0;
+    auto start = std::chrono::steady_clock::now();
+    wasmtime_error_t* err = wasmtime_func_call(context, &runEntry, nullptr, 0, nullptr, 0, &trap);
+    auto runNs = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count();
+    WasmStats& counters = holder->getCounters();
+    counters.add(WasmCounter::RunNs, runNs);
+    counters.add(WasmCounter::RunCount, 1);
+    disarmDeadline(armed);
+
+    counters.add(WasmCounter::HostCalls, hostCalls);
+    counters.add(WasmCounter::BytesIn, action.size() + json.size());
+    counters.add(WasmCounter::BytesOut, out.size());
+    inputAction = {};
+    inputJson = {};
+    outputResult = nullptr;
+
+    if (err || trap) {
+        out = describeFailure("Run", err, trap);
+        logMemoryLimitHint(memoryBefore);
+        holder->getMetrics().record(action, runNs, true);
+        return;
+    }
+
+    bool failed = out.compare(0, 8, "{\"error\"") == 0;
+    if (failed) logMemoryLimitHint(memoryBefore);
+    // 路由返回的业务错误同样计入该 action 的错误数
+    holder->getMetrics().record(action, runNs, failed);
+
+    if (out.empty()) out = "{}";
+}
+
+void WasmExecutor::setDeadline(int64_t timeoutMs, std::shared_ptr<WasmCancelToken> token) {
+    if ((timeoutMs >= 0 || token) && !holder->hasEpochInterruption()) {
+        LOGE("Deadline ignored: engine was created without epoch interruption");
+        return;
+    }
+    hasDeadline = timeoutMs >= 0;
+    if (hasDeadline) deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    cancelToken = std::move(token);
+}
+
+bool WasmExecutor::armDeadline() {
+    interrupt = Interrupt::None;
+    sampler = holder->getActiveSampler();
+    if (!hasDeadline && !cancelToken && !sampler) return false;
+    if (sampler) lastSample = std::chrono::steady_clock::now();
+    // 每个节拍检查一次，由 epoch_callback 判断是否到期 / 是否该采样
+    wasmtime_context_set_epoch_deadline(context, 1);
+    WasmEpochTicker::acquire();
+    return true;
+}
+
+void WasmExecutor::disarmDeadline(bool armed) {
+    if (!armed) return;
+    WasmEpochTicker::release();
+    wasmtime_context_set_epoch_deadline(context, WasmEpochTicker::kNoDeadline);
+}
+
+wasmtime_error_t* WasmExecutor::epoch_callback(wasmtime_context_t* context, void* env,
+                                               uint64_t* epochDeadlineDelta, wasmtime_update_deadline_kind_t* updateKind) {
+    auto* self = (WasmExecutor*)env;
+    if (self->sampler) self->sampleIfDue();
+    if (self->cancelToken && self->cancelToken->isCancelled()) {
+        self->interrupt = Interrupt::Cancelled;
+        return wasmtime_error_new("wasm call cancelled");
+    }
+    if (self->hasDeadline && std::chrono::steady_clock::now() >= self->deadline) {
+        self->interrupt = Interrupt::Timeout;
+        return wasmtime_error_new("wasm call timed out");
+    }
+    *epochDeadlineDelta = 1;
+    *updateKind = WASMTIME_UPDATE_DEADLINE_CONTINUE;
+    return nullptr;
+}
+
+void WasmExecutor::sampleIfDue() {
+    auto now = std::chrono::steady_clock::now();
+    auto delta = std::chrono::duration_cast<std::chrono::nanoseconds>(now - lastSample).count();
+    if (delta < sampler->getIntervalNs()) return;
+    std::string_view action = samplePhase == WasmSampler::Phase::Run ? inputAction
+                                                                     : std::string_view(WasmSampler::kStartupAction);
+    sampler->sample(action, samplePhase, store, (uint64_t)delta);
+    lastSample = now;
+}
+
+std::string WasmExecutor::describeFailure(const char* stage, wasmtime_error_t* err, wasm_trap_t* trap) {
+    wasm_byte_vec_t msg;
+    if (err) wasmtime_error_message(err, &msg);
+    else wasm_trap_message(trap, &msg);
+    LOGE("%s failed: %.*s", stage, (int)msg.size, msg.data);
+    wasm_byte_vec_delete(&msg);
+
+    // 没有回调介入时 (如截止值被意外耗尽) epoch 中断表现为 INTERRUPT Trap，同样按超时处理
+    wasmtime_trap_code_t code;
+    if (trap && interrupt == Interrupt::None && wasmtime_trap_code(trap, &code) && code == WASMTIME_TRAP_CODE_INTERRUPT) {
+        interrupt = Interrupt::Timeout;
+    }
+    if (err) wasmtime_error_delete(err);
+    if (trap) wasm_trap_delete(trap);
+
+    // 中断点可能落在 Kotlin 运行时的任意位置，实例不可再用
+    poisoned = true;
+    switch (interrupt) {
+        case Interrupt::Timeout: return "{\"error\": \"Timeout\"}";
+        case Interrupt::Cancelled: return "{\"error\": \"Cancelled\"}";
+        default: break;
+    }
+    return "{\"error\": \"Run Trap\"}";
+}
+
+size_t WasmExecutor::linearMemorySize() {
+    if (!hasInstance) return 0;
+    wasmtime_extern_t ext;
+    if (!wasmtime_instance_export_get(context, &instance, "memory", 6, &ext) || ext.kind != WASMTIME_EXTERN_MEMORY) {
+        return 0;
+    }
+    return wasmtime_memory_data_size(context, &ext.of.memory);
+}
+
+void WasmExecutor::logMemoryLimitHint(size_t sizeBefore) {
+    if (limits.memorySize < 0) return;
+    // 只有本次调用中确实增长过、且已增长到距上限不足一页时才提示；错误 JSON 保持原样
+    size_t size = linearMemorySize();
+    if (size > sizeBefore && (int64_t)size + 65536 > limits.memorySize) {
+        LOGE("Call failed after linear memory grew to %zu bytes (limit=%lld), possibly due to the memory limit",
+             size, (long long)limits.memorySize);
     }
+}
 
-    return outputResult.empty() ? "{}" : outputResult;
+std::string WasmExecutor::dispatch(std::string_view action, std::string_view json) {
+    std::string out;
+    dispatch(action, json, out);
+    return out;
+}
+
+bool WasmExecutor::invoke(std::string_view name, std::string& error) {
+    if (!instantiate(error)) return false;
+    wasmtime_extern_t ext;
+    if (!wasmtime_instance_export_get(context, &instance, name.data(), name.size(), &ext) ||
+        ext.kind != WASMTIME_EXTERN_FUNC) {
+        error = "{\"error\": \"Export not found\"}";
+        return false;
+    }
+    wasm_trap_t* trap = nullptr;
+    hostCalls = 0;
+    wasmtime_error_t* err = wasmtime_func_call(context, &ext.of.func, nullptr, 0, nullptr, 0, &trap);
+    if (hostCalls > 0) holder->getCounters().add(WasmCounter::HostCalls, hostCalls);
+    if (err || trap) {
+        error = describeFailure("Invoke", err, trap);
+        return false;
+    }
+    return true;
+}
+
+void WasmExecutor::run(std::string_view action, std::string_view json, std::string& out) {
+    if (!instantiate(out)) return;
+    dispatch(action, json, out);
+}
+
+std::string WasmExecutor::run(std::string_view action, std::string_view json) {
+    std::string out;
+    run(action, json, out);
+    return out;
 }
 
 // --- Host Function Implementations ---
@@ -99,8 +340,21 @@ static WasmExecutor* get_self(wasmtime_caller_t* caller) {
     return (WasmExecutor*)wasmtime_context_get_data(wasmtime_caller_context(caller));
 }
 
+// 取调用方导出的线性内存，并校验 [ptr, ptr + len) 不越界
+static uint8_t* get_guest_range(wasmtime_caller_t* caller, uint32_t ptr, uint32_t len) {
+    wasmtime_extern_t ext;
+    if (!wasmtime_caller_export_get(caller, "memory", 6, &ext) || ext.kind != WASMTIME_EXTERN_MEMORY) {
+        return nullptr;
+    }
+    wasmtime_context_t* ctx = wasmtime_caller_context(caller);
+    size_t size = wasmtime_memory_data_size(ctx, &ext.of.memory);
+    if ((uint64_t)ptr + len > size) return nullptr;
+    return wasmtime_memory_data(ctx, &ext.of.memory) + ptr;
+}
+
 wasm_trap_t* WasmExecutor::host_get_action_size(void* env, wasmtime_caller_t* caller, const wasmtime_val_t* args, size_t nargs, wasmtime_val_t* results, size_t nresults) {
     auto* self = get_self(caller);
+    self->hostCalls++;
     results[0].kind = WASMTIME_I32;
     results[0].of.i32 = (int32_t)self->inputAction.size();
     return nullptr;
@@ -108,6 +362,7 @@ wasm_trap_t* WasmExecutor::host_get_action_size(void* env, wasmtime_caller_t* ca
 
 wasm_trap_t* WasmExecutor::host_get_json_size(void* env, wasmtime_caller_t* caller, const wasmtime_val_t* args, size_t nargs, wasmtime_val_t* results, size_t nresults) {
     auto* self = get_self(caller);
+    self->hostCalls++;
     results[0].kind = WASMTIME_I32;
     results[0].of.i32 = (int32_t)self->inputJson.size();
     return nullptr;
@@ -115,9 +370,10 @@ wasm_trap_t* WasmExecutor::host_get_json_size(void* env, wasmtime_caller_t* call
 
 wasm_trap_t* WasmExecutor::host_read_input_byte(void* env, wasmtime_caller_t* caller, const wasmtime_val_t* args, size_t nargs, wasmtime_val_t* results, size_t nresults) {
     auto* self = get_self(caller);
+    self->hostCalls++;
     int32_t type = args[0].of.i32; // 0=action, 1=json
     int32_t index = args[1].of.i32;
-    const std::string* target = (type == 0) ? &self->inputAction : &self->inputJson;
+    const std::string_view* target = (type == 0) ? &self->inputAction : &self->inputJson;
 
     if (index < 0 || index >= target->size()) {
         return wasmtime_trap_new("Index OOB", 9);
@@ -129,6 +385,55 @@ wasm_trap_t* WasmExecutor::host_read_input_byte(void* env, wasmtime_caller_t* ca
 
 wasm_trap_t* WasmExecutor::host_write_result_byte(void* env, wasmtime_caller_t* caller, const wasmtime_val_t* args, size_t nargs, wasmtime_val_t* results, size_t nresults) {
     auto* self = get_self(caller);
-    self->outputResult += (char)args[0].of.i32;
+    self->hostCalls++;
+    if (!self->outputResult) return wasmtime_trap_new("No output buffer", 16);
+    *self->outputResult += (char)args[0].of.i32;
+    return nullptr;
+}
+
+wasm_trap_t* WasmExecutor::host_read_input(void* env, wasmtime_caller_t* caller, const wasmtime_val_t* args, size_t nargs, wasmtime_val_t* results, size_t nresults) {
+    auto* self = get_self(caller);
+    self->hostCalls++;
+    int32_t type = args[0].of.i32; // 0=action, 1=json
+    auto ptr = (uint32_t)args[1].of.i32;
+    auto len = (uint32_t)args[2].of.i32;
+    const std::string_view* target = (type == 0) ? &self->inputAction : &self->inputJson;
+
+    size_t count = len < target->size() ? len : target->size();
+    uint8_t* dst = get_guest_range(caller, ptr, (uint32_t)count);
+    if (!dst) {
+        return wasmtime_trap_new("Guest memory OOB", 16);
+    }
+    memcpy(dst, target->data(), count);
+    results[0].kind = WASMTIME_I32;
+    results[0].of.i32 = (int32_t)count;
     return nullptr;
-}
\ No newline at end of file
+}
+
+wasm_trap_t* WasmExecutor::host_write_result(void* env, wasmtime_caller_t* caller, const wasmtime_val_t* args, size_t nargs, wasmtime_val_t* results, size_t nresults) {
+    auto* self = get_self(caller);
+    self->hostCalls++;
+    auto ptr = (uint32_t)args[0].of.i32;
+    auto len = (uint32_t)args[1].of.i32;
+
+    const uint8_t* src = get_guest_range(caller, ptr, len);
+    if (!src || !self->outputResult) {
+        return wasmtime_trap_new("Guest memory OOB", 16);
+    }
+    self->outputResult->append((const char*)src, len);
+    return nullptr;
+}
+
+wasm_trap_t* WasmExecutor::host_declare_pure(void* env, wasmtime_caller_t* caller, const wasmtime_val_t* args, size_t nargs, wasmtime_val_t* results, size_t nresults) {
+    auto* self = get_self(caller);
+    self->hostCalls++;
+    auto ptr = (uint32_t)args[0].of.i32;
+    auto len = (uint32_t)args[1].of.i32;
+
+    const uint8_t* src = get_guest_range(caller, ptr, len);
+    if (!src) {
+        return wasmtime_trap_new("Guest memory OOB", 16);
+    }
+    self->holder->getResultCache().declarePure(std::string_view((const char*)src, len));
+    return nullptr;
+}
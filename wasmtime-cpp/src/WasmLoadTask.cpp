@@ -0,0 +1,104 @@
+#include "WasmLoadTask.h"
+#include "WasmModule.h"
+#include "WasmModuleCache.h"
+#include "JniUtils.h"
+#include <chrono>
+#include <thread>
+#include <unistd.h>
+
+WasmLoadTask::~WasmLoadTask() {
+    // 模块未被取走，由任务负责释放
+    delete module;
+}
+
+std::shared_ptr<WasmLoadTask> WasmLoadTask::start(const std::string& sourcePath, const std::string& cachePath,
+                                                  const WasmConfig& config) {
+    std::shared_ptr<WasmLoadTask> task(new WasmLoadTask());
+    try {
+        // 工作线程持有任务的引用，调用方提前释放句柄也不会悬空
+        std::thread([task, sourcePath, cachePath, config] { task->run(sourcePath, cachePath, config); }).detach();
+    } catch (const std::system_error& e) {
+        LOGE("Failed to start load thread: %s", e.what());
+        task->complete(nullptr);
+    }
+    return task;
+}
+
+void WasmLoadTask::run(const std::string& sourcePath, const std::string& cachePath, const WasmConfig& config) {
+    // 1. 尝试 AOT 缓存
+    if (!cachePath.empty() && JniUtils::fileExists(cachePath)) {
+        if (auto* cached = WasmModule::loadFromPath(cachePath, config)) {
+            complete(cached);
+            return;
+        }
+        // 缓存损坏或过期，删除后重新编译
+        unlink(cachePath.c_str());
+        WasmModuleCache::removeHeader(cachePath);
+    }
+
+    // 2. JIT 编译源码
+    WasmModule* compiled = WasmModule::loadFromSourcePath(sourcePath, config);
+
+    // 只保留编译产物的引用，调用方拿到模块后即使马上释放也不影响后台写缓存
+    std::shared_ptr<wasmtime_module_t> artifact;
+    uint64_t sourceHash = 0;
+    bool hasSourceHash = false;
+    if (compiled && !cachePath.empty()) {
+        artifact = compiled->getModuleRef();
+        hasSourceHash = compiled->getSourceHash(sourceHash);
+    }
+
+    // 3. 先通知等待者，再写缓存
+    complete(compiled);
+    if (artifact) {
+        WasmModule::writeCache(artifact, hasSourceHash, sourceHash, config.fingerprint(), cachePath);
+    }
+}
+
+void WasmLoadTask::complete(WasmModule* loaded) {
+    std::vector<Callback> pending;
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        module = loaded;
+        success = loaded != nullptr;
+        done = true;
+        pending.swap(callbacks);
+    }
+    cond.notify_all();
+    for (auto& callback : pending) callback(loaded != nullptr);
+}
+
+bool WasmLoadTask::isDone() {
+    std::lock_guard<std::mutex> guard(lock);
+    return done;
+}
+
+bool WasmLoadTask::await(int64_t timeoutMs) {
+    std::unique_lock<std::mutex> guard(lock);
+    if (timeoutMs < 0) {
+        cond.wait(guard, [this] { return done; });
+    } else if (!cond.wait_for(guard, std::chrono::milliseconds(timeoutMs), [this] { return done; })) {
+        return false;
+    }
+    return success;
+}
+
+void WasmLoadTask::onComplete(Callback callback) {
+    bool result;
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        if (!done) {
+            callbacks.push_back(std::move(callback));
+            return;
+        }
+        result = success;
+    }
+    callback(result);
+}
+
+WasmModule* WasmLoadTask::take() {
+    std::lock_guard<std::mutex> guard(lock);
+    WasmModule* loaded = module;
+    module = nullptr;
+    return loaded;
+}
\ No newline at end of file
@@ -0,0 +1,144 @@
+#include "WasmLogSink.h"
+#include "WasmMpmcQueue.h"
+#include <chrono>
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
+namespace {
+    // 定长日志槽位，入队时整体拷贝，不涉及堆分配
+    struct LogRecord {
+        WasmLogLevel level = WasmLogLevel::Info;
+        uint16_t length = 0;
+        char tag[32] = {};
+        char text[220] = {};
+    };
+
+    constexpr size_t kQueueCapacity = 1024;
+    constexpr auto kDrainInterval = std::chrono::milliseconds(20);
+
+    void defaultBackend(WasmLogLevel level, const char* tag, const char* message, size_t length) {
+#ifdef __ANDROID__
+        __android_log_print((int)level, tag, "%.*s", (int)length, message);
+#else
+        static const char kLevels[] = "??VDIWEF";
+        fprintf(stderr, "%c/%s: %.*s\n", kLevels[(int)level & 7], tag, (int)length, message);
+#endif
+    }
+
+    std::atomic<WasmLogSink::Backend> g_backend{defaultBackend};
+    std::atomic<uint32_t> g_queueDropped{0};
+    WasmMpmcQueue<LogRecord>* g_queue = nullptr;
+    std::once_flag g_startOnce;
+
+    int64_t currentSecond() {
+        return std::chrono::duration_cast<std::chrono::seconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    void push(const char* tag, WasmLogLevel level, const char* text, size_t length) {
+        LogRecord record;
+        record.level = level;
+        strncpy(record.tag, tag, sizeof(record.tag) - 1);
+        record.length = (uint16_t)std::min(length, sizeof(record.text));
+        memcpy(record.text, text, record.length);
+        if (!g_queue->push(std::move(record))) g_queueDropped.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void drain() {
+        LogRecord record;
+        WasmLogSink::Backend backend = g_backend.load(std::memory_order_acquire);
+        while (g_queue->pop(record)) backend(record.level, record.tag, record.text, record.length);
+
+        uint32_t lost = g_queueDropped.exchange(0, std::memory_order_relaxed);
+        if (lost > 0) {
+            char msg[64];
+            int len = snprintf(msg, sizeof(msg), "%u log lines dropped (queue full)", lost);
+            backend(WasmLogLevel::Warn, TAG, msg, (size_t)len);
+        }
+    }
+
+    void start() {
+        std::call_once(g_startOnce, [] {
+            g_queue = new WasmMpmcQueue<LogRecord>(kQueueCapacity);
+            try {
+                // 定时批量输出: 写入端从不唤醒后台线程，省掉每行一次的系统调用
+                std::thread([] {
+                    while (true) {
+                        std::this_thread::sleep_for(kDrainInterval);
+                        drain();
+                    }
+                }).detach();
+            } catch (const std::system_error& e) {
+                LOGE("Failed to start log drain thread: %s", e.what());
+            }
+        });
+    }
+}
+
+void WasmLogTarget::setTag(const std::string& value) {
+    size_t length = std::min(value.size(), sizeof(tag) - 1);
+    memcpy(tag, value.data(), length);
+    tag[length] = '\0';
+}
+
+bool WasmLogPolicy::allow(const char* tag) {
+    uint32_t limit = maxLinesPerSecond.load(std::memory_order_relaxed);
+    if (limit == 0) return true;
+
+    int64_t now = currentSecond();
+    int64_t window = windowSecond.load(std::memory_order_relaxed);
+    if (window != now && windowSecond.compare_exchange_strong(window, now, std::memory_order_relaxed)) {
+        windowCount.store(0, std::memory_order_relaxed);
+        // 新窗口开始时补报上一窗口被限流丢弃的行数
+        uint32_t lost = dropped.exchange(0, std::memory_order_relaxed);
+        if (lost > 0) {
+            char msg[64];
+            int len = snprintf(msg, sizeof(msg), "%u log lines dropped (rate limit)", lost);
+            push(tag, WasmLogLevel::Warn, msg, (size_t)len);
+        }
+    }
+    if (windowCount.fetch_add(1, std::memory_order_relaxed) < limit) return true;
+    dropped.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+void WasmLogSink::setBackend(Backend backend) {
+    g_backend.store(backend ? backend : defaultBackend, std::memory_order_release);
+}
+
+void WasmLogSink::write(WasmLogTarget& target, WasmLogLevel level, const char* data, size_t size) {
+    WasmLogPolicy& policy = *target.policy;
+    if ((int)level < policy.level.load(std::memory_order_relaxed) || size == 0 || !data) return;
+    start();
+
+    const char* end = data + size;
+    while (data < end) {
+        const char* newline = (const char*)memchr(data, '\n', end - data);
+        const char* lineEnd = newline ? newline : end;
+        size_t length = lineEnd - data;
+        if (length > 0 && data[length - 1] == '\r') length--;
+
+        // 空行不输出；超长行按槽位切分
+        for (size_t offset = 0; offset < length; offset += sizeof(LogRecord::text)) {
+            if (!policy.allow(target.tag)) return;
+            push(target.tag, level, data + offset, std::min(length - offset, sizeof(LogRecord::text)));
+        }
+        data = newline ? newline + 1 : end;
+    }
+}
+
+void WasmLogSink::flush() {
+    if (g_queue) drain();
+}
+
+ptrdiff_t WasmLogSink::wasiStdout(void* data, const unsigned char* buffer, size_t size) {
+    write(*static_cast<WasmLogTarget*>(data), WasmLogLevel::Info, (const char*)buffer, size);
+    return (ptrdiff_t)size;
+}
+
+ptrdiff_t WasmLogSink::wasiStderr(void* data, const unsigned char* buffer, size_t size) {
+    write(*static_cast<WasmLogTarget*>(data), WasmLogLevel::Warn, (const char*)buffer, size);
+    return (ptrdiff_t)size;
+}
\ No newline at end of file
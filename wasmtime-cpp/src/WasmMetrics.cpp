@@ -0,0 +1,208 @@
+#include "WasmMetrics.h"
+#include "JniUtils.h"
+#include <algorithm>
+#include <cstdio>
+#include <functional>
+#include <sstream>
+
+namespace {
+    // JSON 字符串转义: 引号、反斜杠与全部 0x20 以下的控制字符
+    std::string escapeJson(std::string_view value) {
+        std::string out;
+        out.reserve(value.size());
+        for (char c : value) {
+            switch (c) {
+                case '"': out += "\\\""; break;
+                case '\\': out += "\\\\"; break;
+                case '\n': out += "\\n"; break;
+                case '\r': out += "\\r"; break;
+                case '\t': out += "\\t"; break;
+                default:
+                    if ((unsigned char)c < 0x20) {
+                        char buf[8];
+                        snprintf(buf, sizeof(buf), "\\u%04x", (unsigned char)c);
+                        out += buf;
+                    } else {
+                        out += c;
+                    }
+            }
+        }
+        return out;
+    }
+
+    // Prometheus 标签值转义: 文本格式只定义了反斜杠、引号与换行，其余控制字符替换为空格
+    std::string escapeLabel(std::string_view value) {
+        std::string out;
+        out.reserve(value.size());
+        for (char c : value) {
+            if (c == '"' || c == '\\') out += '\\';
+            if (c == '\n') { out += "\\n"; continue; }
+            out += (unsigned char)c < 0x20 ? ' ' : c;
+        }
+        return out;
+    }
+
+    const double kQuantiles[] = {0.5, 0.9, 0.99, 0.999};
+    const char* const kQuantileNames[] = {"p50", "p90", "p99", "p999"};
+}
+
+// --- WasmHistogram ---
+
+int WasmHistogram::bucketOf(uint64_t ns) {
+    if (ns < 16) return (int)ns;
+    int exponent = 63 - __builtin_clzll(ns); // >= 4
+    int sub = (int)((ns >> (exponent - 3)) & (kSubBuckets - 1));
+    return 16 + (exponent - 4) * kSubBuckets + sub;
+}
+
+uint64_t WasmHistogram::upperBoundOf(int bucket) {
+    if (bucket < 16) return (uint64_t)bucket;
+    int exponent = (bucket - 16) / kSubBuckets + 4;
+    int sub = (bucket - 16) % kSubBuckets;
+    // 指数 63 的最后一个子桶上界会溢出，截断为最大值
+    if (exponent == 63 && sub == kSubBuckets - 1) return UINT64_MAX;
+    return ((uint64_t)(kSubBuckets + sub + 1) << (exponent - 3)) - 1;
+}
+
+void WasmHistogram::record(uint64_t ns) {
+    buckets[bucketOf(ns)].fetch_add(1, std::memory_order_relaxed);
+    total.fetch_add(1, std::memory_order_relaxed);
+    sumNs.fetch_add(ns, std::memory_order_relaxed);
+    uint64_t current = maxNs.load(std::memory_order_relaxed);
+    while (ns > current && !maxNs.compare_exchange_weak(current, ns, std::memory_order_relaxed)) {}
+}
+
+void WasmHistogram::reset() {
+    for (auto& bucket : buckets) bucket.store(0, std::memory_order_relaxed);
+    total.store(0, std::memory_order_relaxed);
+    sumNs.store(0, std::memory_order_relaxed);
+    maxNs.store(0, std::memory_order_relaxed);
+}
+
+uint64_t WasmHistogram::percentile(double q) const {
+    // 以各桶之和为准 (并发记录时 total 可能与桶计数有瞬时偏差)
+    uint64_t counts[kBuckets];
+    uint64_t n = 0;
+    for (int i = 0; i < kBuckets; ++i) {
+        counts[i] = buckets[i].load(std::memory_order_relaxed);
+        n += counts[i];
+    }
+    if (n == 0) return 0;
+
+    auto rank = (uint64_t)(q * (double)(n - 1)) + 1;
+    uint64_t seen = 0;
+    for (int i = 0; i < kBuckets; ++i) {
+        seen += counts[i];
+        if (seen >= rank) return std::min(upperBoundOf(i), max());
+    }
+    return max();
+}
+
+// --- WasmMetrics ---
+
+WasmMetrics::Entry* WasmMetrics::find(std::string_view action, size_t hash) const {
+    for (size_t i = 0; i < kSlots; ++i) {
+        Entry* entry = slots[(hash + i) & (kSlots - 1)].load(std::memory_order_acquire);
+        if (!entry) return nullptr;
+        if (entry->hash == hash && entry->action == action) return entry;
+    }
+    return nullptr;
+}
+
+WasmMetrics::Entry* WasmMetrics::findOrCreate(std::string_view action) {
+    size_t hash = std::hash<std::string_view>()(action);
+    if (Entry* entry = find(action, hash)) return entry;
+
+    std::lock_guard<std::mutex> guard(lock);
+    if (Entry* entry = find(action, hash)) return entry;
+    if (entries.size() >= kMaxActions) {
+        action = "_other";
+        hash = std::hash<std::string_view>()(action);
+        if (Entry* other = find(action, hash)) return other;
+    }
+    auto entry = std::make_unique<Entry>();
+    entry->hash = hash;
+    entry->action = std::string(action);
+    // kMaxActions + 1 (_other) 远小于槽位数，线性探测必能找到空槽
+    size_t slot = hash & (kSlots - 1);
+    while (slots[slot].load(std::memory_order_relaxed)) slot = (slot + 1) & (kSlots - 1);
+    slots[slot].store(entry.get(), std::memory_order_release);
+    entries.push_back(std::move(entry));
+    return entries.back().get();
+}
+
+void WasmMetrics::record(std::string_view action, uint64_t ns, bool error) {
+    Entry* entry = findOrCreate(action);
+    entry->latency.record(ns);
+    if (error) entry->errors.fetch_add(1, std::memory_order_relaxed);
+}
+
+void WasmMetrics::reset() {
+    std::lock_guard<std::mutex> guard(lock);
+    for (auto& entry : entries) {
+        entry->latency.reset();
+        entry->errors.store(0, std::memory_order_relaxed);
+    }
+}
+
+std::string WasmMetrics::snapshot(Format format, const std::string& module) const {
+    return format == Format::Prometheus ? toPrometheus(module) : toJson(module);
+}
+
+bool WasmMetrics::writeSnapshot(const std::string& path, Format format, const std::string& module) const {
+    std::string text = snapshot(format, module);
+    std::string error;
+    if (!JniUtils::writeFileAtomic(path, reinterpret_cast<const uint8_t*>(text.data()), text.size(), &error)) {
+        LOGE("Metrics save failed: %s", error.c_str());
+        return false;
+    }
+    return true;
+}
+
+std::string WasmMetrics::toJson(const std::string& module) const {
+    std::ostringstream os;
+    os << "{";
+    if (!module.empty()) os << "\"module\": \"" << escapeJson(module) << "\", ";
+    // 延迟只统计 run_entry，Store 创建 / 实例化 / _initialize 见 stats()
+    os << "\"latency\": \"run_entry\", \"actions\": [";
+    std::lock_guard<std::mutex> guard(lock);
+    for (size_t i = 0; i < entries.size(); ++i) {
+        const Entry& entry = *entries[i];
+        const WasmHistogram& h = entry.latency;
+        uint64_t count = h.count();
+        os << (i > 0 ? ", " : "") << "{\"action\": \"" << escapeJson(entry.action) << "\", \"count\": " << count
+           << ", \"errors\": " << entry.errors.load(std::memory_order_relaxed)
+           << ", \"mean_us\": " << (count ? (double)h.sum() / (double)count / 1000.0 : 0.0);
+        for (size_t q = 0; q < 4; ++q) {
+            os << ", \"" << kQuantileNames[q] << "_us\": " << (double)h.percentile(kQuantiles[q]) / 1000.0;
+        }
+        os << ", \"max_us\": " << (double)h.max() / 1000.0 << "}";
+    }
+    os << "]}";
+    return os.str();
+}
+
+std::string WasmMetrics::toPrometheus(const std::string& module) const {
+    std::string moduleLabel = module.empty() ? "" : "module=\"" + escapeLabel(module) + "\",";
+    std::ostringstream latency, errors;
+    latency << "# HELP wasmline_action_latency_seconds run_entry latency per action "
+               "(excludes store creation, instantiation and _initialize)\n"
+            << "# TYPE wasmline_action_latency_seconds summary\n";
+    errors << "# HELP wasmline_action_errors_total Failed calls per action\n"
+           << "# TYPE wasmline_action_errors_total counter\n";
+
+    std::lock_guard<std::mutex> guard(lock);
+    for (const auto& entry : entries) {
+        const WasmHistogram& h = entry->latency;
+        std::string labels = moduleLabel + "action=\"" + escapeLabel(entry->action) + "\"";
+        for (double q : kQuantiles) {
+            latency << "wasmline_action_latency_seconds{" << labels << ",quantile=\"" << q << "\"} "
+                    << (double)h.percentile(q) / 1e9 << "\n";
+        }
+        latency << "wasmline_action_latency_seconds_sum{" << labels << "} " << (double)h.sum() / 1e9 << "\n"
+                << "wasmline_action_latency_seconds_count{" << labels << "} " << h.count() << "\n";
+        errors << "wasmline_action_errors_total{" << labels << "} "
+               << entry->errors.load(std::memory_order_relaxed) << "\n";
+    }
+    return latency.str() + errors.str();
+}
@@ -1,8 +1,11 @@
 #include "WasmModule.h"
-#include "WasmConfig.h"
+#include "WasmEngineRegistry.h"
 #include "WasmExecutor.h"
+#include "WasmModuleCache.h"
+#include "WasmWorkerPool.h"
 #include "JniUtils.h"
 #include <chrono>
+#include <cstdlib>
 
 // 辅助：计算耗时
 static long long current_ms() {
@@ -13,110 +16,256 @@ static long long current_ms() {
 WasmModule::WasmModule() {}
 
 WasmModule::~WasmModule() {
-    if (linker) wasmtime_linker_delete(linker);
-    if (module) wasmtime_module_delete(module);
-    if (engine) wasm_engine_delete(engine);
-}
-
-// 全局唯一的 Engine 指针
-static wasm_engine_t* g_engine = nullptr;
-
-// 获取全局 Engine（懒加载，线程安全由 C++11 静态变量保证，或者单纯依靠主线程初始化）
-static wasm_engine_t* getGlobalEngine() {
-    if (!g_engine) {
-        // 1. 创建配置
-        wasm_config_t* conf = WasmConfig::createAndroidConfig();
-        
-        // 2. 创建 Engine (Engine 会接管 Config 的所有权)
-        g_engine = wasm_engine_new_with_config(conf);
-        
-        if (!g_engine) {
-            LOGE("FATAL: Failed to create global wasm engine!");
-        } else {
-            LOGI("Global Wasm Engine initialized.");
+    // 线程池里还有本模块的任务 (含排队中的)，等它们跑完再释放 Linker / InstancePre；会阻塞调用线程
+    {
+        std::unique_lock<std::mutex> guard(asyncLock);
+        // 在工作线程上等待池内任务 (包括在自己的回调里释放本模块) 会自锁，线程池只有一个线程时必然死锁
+        if (asyncPending > 0 && WasmWorkerPool::isWorkerThread()) {
+            LOGE("WasmModule released on a wasm worker thread with %d async calls pending, abort", asyncPending);
+            std::abort();
         }
+        asyncIdle.wait(guard, [this] { return asyncPending == 0; });
     }
-    return g_engine;
+    if (instancePre) wasmtime_instance_pre_delete(instancePre);
+    if (linker && ownsLinker) wasmtime_linker_delete(linker);
+    // module 由 shared_ptr 释放；engine 归 WasmEngineRegistry 所有，不能在这里删除
 }
 
-bool WasmModule::initCommon() {
+bool WasmModule::initCommon(const WasmConfig& config) {
 
-    // 获取全局单例
-    engine = getGlobalEngine();
+    // 同一配置的模块共用一个 Engine
+    engine = WasmEngineRegistry::acquire(config);
     if (!engine) {
         LOGE("Failed to create engine");
         return false;
     }
+    configFingerprint = config.fingerprint();
+    engineKey = config.engineKey();
+    epochInterruption = config.hasEpochInterruption();
 
-    // 3. 创建 Linker 并配置 WASI
-    linker = wasmtime_linker_new(engine);
-    wasmtime_linker_define_wasi(linker);
+    // 共享 Linker 已注册 WASI 与 Host Functions，不再为每个模块重复构建
+    linker = WasmEngineRegistry::sharedLinker(engine);
+    ownsLinker = false;
 
-    // 4. 注册 Host Functions
-    // 这里将具体的函数注册逻辑交给 Executor 处理
-    WasmExecutor::registerHostFunctions(linker);
+    return linker != nullptr;
+}
+
+bool WasmModule::initInstancePre() {
+    if (instancePre) {
+        wasmtime_instance_pre_delete(instancePre);
+        instancePre = nullptr;
+    }
 
+    // Linker 已注册 WASI 与 Host Functions，这里一次性解析全部导入
+    wasmtime_error_t* err = wasmtime_linker_instantiate_pre(linker, module.get(), &instancePre);
+    if (err) {
+        wasm_byte_vec_t msg;
+        wasmtime_error_message(err, &msg);
+        LOGE("InstancePre failed (unresolved imports): %s", msg.data);
+        wasm_byte_vec_delete(&msg);
+        wasmtime_error_delete(err);
+        return false;
+    }
     return true;
 }
 
-WasmModule* WasmModule::loadFromPath(const std::string& path) {
-    if (!JniUtils::fileExists(path)) {
-        LOGI("Cache file not found: %s", path.c_str());
-        return nullptr;
+bool WasmModule::finishLoad(bool deferImports) {
+    inspectModule();
+    if (initInstancePre()) {
+        capturePureDeclarations();
+        return true;
+    }
+    // 显式选择延迟绑定时保留模块，由调用方在首次 call 之前通过 defineImport 补齐
+    if (deferImports) {
+        LOGI("Unresolved imports deferred, define them via defineImport before the first call");
+        return true;
     }
+    return false;
+}
 
-    auto start = current_ms();
-    // 从 C++ 层直接读取文件，不经过 Java
-    auto data = JniUtils::readFile(path);
-    if (data.empty()) return nullptr;
+// 预初始化标记导出: 快照工具 (或插件自身) 导出该名字即表示 _initialize 的效果已固化在模块里
+static constexpr char kPreInitializedMarker[] = "__wasmline_preinitialized";
+// 纯函数声明导出: 预初始化模块不再执行 _initialize，由它在加载时重新调用 host_declare_pure
+static constexpr char kDeclarePureExport[] = "__wasmline_declare_pure";
+
+void WasmModule::inspectModule() {
+    // 只有导入了 WASI 的模块才需要为每个 Store 建立 WASI 上下文
+    wasm_importtype_vec_t imports;
+    wasmtime_module_imports(module.get(), &imports);
+    usesWasi = false;
+    importsDeclarePure = false;
+    for (size_t i = 0; i < imports.size; ++i) {
+        const wasm_name_t* name = wasm_importtype_module(imports.data[i]);
+        std::string_view view(name->data, name->size);
+        if (view == "wasi_snapshot_preview1" || view == "wasi_unstable") usesWasi = true;
+        const wasm_name_t* field = wasm_importtype_name(imports.data[i]);
+        if (view == "env" && std::string_view(field->data, field->size) == "host_declare_pure") importsDeclarePure = true;
+    }
+    wasm_importtype_vec_delete(&imports);
+    if (!usesWasi) LOGI("Module does not import WASI, stores skip WASI setup");
+
+    wasm_exporttype_vec_t exports;
+    wasmtime_module_exports(module.get(), &exports);
+    bool hasInitialize = false;
+    bool hasMarker = false;
+    for (size_t i = 0; i < exports.size; ++i) {
+        const wasm_name_t* name = wasm_exporttype_name(exports.data[i]);
+        std::string_view view(name->data, name->size);
+        if (view == "_initialize") hasInitialize = true;
+        else if (view == kPreInitializedMarker) hasMarker = true;
+        else if (view == kDeclarePureExport) hasDeclarePure = true;
+    }
+    wasm_exporttype_vec_delete(&exports);
 
-    auto* instance = new WasmModule();
-    if (!instance->initCommon()) { delete instance; return nullptr; }
+    // Wizer 会把初始化函数从导出中移除；显式标记则覆盖仍保留 _initialize 导出的情况
+    preInitialized = hasMarker || !hasInitialize;
+    if (hasMarker) LOGI("Module is pre-initialized, _initialize will be skipped");
+}
 
-    LOGI("AOT Deserialize... size=%zu", data.size());
-    
-    // 反序列化
-    wasmtime_error_t* err = wasmtime_module_deserialize(instance->engine, data.data(), data.size(), &instance->module);
+void WasmModule::capturePureDeclarations() {
+    if (!preInitialized) return;
+    if (hasDeclarePure) {
+        // 单独建一个 Store 调用声明导出，只为收集 host_declare_pure，结果不保留
+        WasmExecutor exec(this);
+        std::string error;
+        if (!exec.invoke(kDeclarePureExport, error)) LOGE("%s failed: %s", kDeclarePureExport, error.c_str());
+    } else if (importsDeclarePure) {
+        // 快照时 _initialize 里的 registerPure 声明已丢失，结果缓存只认 Host 侧声明的 action
+        LOGE("Pre-initialized module imports host_declare_pure but does not export %s: "
+             "pure actions declared in _initialize are lost, declare them via the result cache config",
+             kDeclarePureExport);
+    }
+}
+
+bool WasmModule::compileSource(const uint8_t* data, size_t size) {
+    // 进程内缓存的编译产物绑定在具体 Engine 上，按引擎键区分
+    uint64_t key = engineKey;
+    sourceHash = WasmModuleCache::hashBytes(data, size);
+    hasSourceHash = true;
+
+    // 同一插件已被其他 WasmModule 加载过，直接共享编译产物
+    module = WasmModuleCache::find(sourceHash, key);
+    if (module) {
+        LOGI("Module cache hit, skip compile (hash=%016llx)", (unsigned long long)sourceHash);
+        return true;
+    }
+
+    wasmtime_module_t* raw = nullptr;
+    wasmtime_error_t* err = wasmtime_module_new(engine, data, size, &raw);
     if (err) {
         wasm_byte_vec_t msg;
         wasmtime_error_message(err, &msg);
-        LOGE("Deserialize failed: %s", msg.data);
+        LOGE("Compile failed: %s", msg.data);
         wasm_byte_vec_delete(&msg);
         wasmtime_error_delete(err);
-        delete instance;
+        return false;
+    }
+    module = WasmModuleCache::put(sourceHash, key, raw);
+    return true;
+}
+
+WasmModule* WasmModule::loadFromPath(const std::string& path, const WasmConfig& config, bool useMmap,
+                                     bool deferImports) {
+    if (!JniUtils::fileExists(path)) {
+        LOGI("Cache file not found: %s", path.c_str());
         return nullptr;
     }
 
+    auto start = current_ms();
+    auto* instance = new WasmModule();
+    if (!instance->initCommon(config)) { delete instance; return nullptr; }
+
+    // 0. 反序列化前先校验缓存头: 配置/版本不一致或文件被截断都直接判定为过期
+    uint64_t fp = instance->configFingerprint;
+    WasmCacheHeader header;
+    if (WasmModuleCache::readHeader(path, header)) {
+        if (header.configFingerprint != fp) {
+            LOGI("Cache is stale (engine config or wasmtime version changed): %s", path.c_str());
+            delete instance;
+            return nullptr;
+        }
+        if ((int64_t)header.payloadSize != JniUtils::fileSize(path)) {
+            LOGI("Cache size mismatch, treat as torn: %s", path.c_str());
+            delete instance;
+            return nullptr;
+        }
+        instance->sourceHash = header.sourceHash;
+        instance->hasSourceHash = true;
+        instance->module = WasmModuleCache::find(header.sourceHash, instance->engineKey);
+        if (instance->module) LOGI("Module cache hit, skip deserialize: %s", path.c_str());
+    } else {
+        LOGI("Cache header missing, relying on wasmtime compatibility check: %s", path.c_str());
+    }
+
+    wasmtime_module_t* raw = nullptr;
+
+    // 1. 默认 mmap: Wasmtime 直接映射文件，不经过 vector 中转，也不再额外拷贝一份
+    if (!instance->module && useMmap) {
+        LOGI("AOT Deserialize (mmap)... %s", path.c_str());
+        wasmtime_error_t* err = wasmtime_module_deserialize_file(instance->engine, path.c_str(), &raw);
+        if (err) {
+            wasm_byte_vec_t msg;
+            wasmtime_error_message(err, &msg);
+            LOGE("Deserialize (mmap) failed, fallback to buffered: %s", msg.data);
+            wasm_byte_vec_delete(&msg);
+            wasmtime_error_delete(err);
+            raw = nullptr;
+        }
+    }
+
+    // 2. 回退: 从 C++ 层读取整个文件再反序列化
+    if (!instance->module && !raw) {
+        auto data = JniUtils::readFile(path);
+        if (data.empty()) { delete instance; return nullptr; }
+
+        LOGI("AOT Deserialize... size=%zu", data.size());
+
+        wasmtime_error_t* err = wasmtime_module_deserialize(instance->engine, data.data(), data.size(), &raw);
+        if (err) {
+            wasm_byte_vec_t msg;
+            wasmtime_error_message(err, &msg);
+            LOGE("Deserialize failed: %s", msg.data);
+            wasm_byte_vec_delete(&msg);
+            wasmtime_error_delete(err);
+            delete instance;
+            return nullptr;
+        }
+    }
+
+    if (raw) {
+        instance->module = instance->hasSourceHash
+                ? WasmModuleCache::put(instance->sourceHash, instance->engineKey, raw)
+                : std::shared_ptr<wasmtime_module_t>(raw, wasmtime_module_delete);
+    }
+
+    // 导入未能全部解析时加载失败，避免为一个无法调用的模块写出 .cwasm 缓存
+    if (!instance->finishLoad(deferImports)) { delete instance; return nullptr; }
+
     LOGI("AOT Success. Time: %lld ms", (current_ms() - start));
     return instance;
 }
 
-WasmModule* WasmModule::loadFromSource(const std::vector<uint8_t>& source) {
+WasmModule* WasmModule::loadFromSource(const std::vector<uint8_t>& source, const WasmConfig& config,
+                                       bool deferImports) {
     if (source.empty()) return nullptr;
 
     auto start = current_ms();
     auto* instance = new WasmModule();
-    if (!instance->initCommon()) { delete instance; return nullptr; }
+    if (!instance->initCommon(config)) { delete instance; return nullptr; }
 
     LOGI("JIT Compiling... size=%zu", source.size());
 
     // 编译源码
-    wasmtime_error_t* err = wasmtime_module_new(instance->engine, source.data(), source.size(), &instance->module);
-    if (err) {
-        wasm_byte_vec_t msg;
-        wasmtime_error_message(err, &msg);
-        LOGE("Compile failed: %s", msg.data);
-        wasm_byte_vec_delete(&msg);
-        wasmtime_error_delete(err);
-        delete instance;
-        return nullptr;
-    }
+    if (!instance->compileSource(source.data(), source.size())) { delete instance; return nullptr; }
+
+    // 导入未能全部解析时加载失败，避免为一个无法调用的模块写出 .cwasm 缓存
+    if (!instance->finishLoad(deferImports)) { delete instance; return nullptr; }
 
     LOGI("JIT Success. Time: %lld ms", (current_ms() - start));
     return instance;
 }
 
-WasmModule* WasmModule::loadFromSourcePath(const std::string& path) {
+WasmModule* WasmModule::loadFromSourcePath(const std::string& path, const WasmConfig& config, bool deferImports) {
     if (!JniUtils::fileExists(path)) {
         LOGE("Source file not found: %s", path.c_str());
         return nullptr;
@@ -129,32 +278,31 @@ WasmModule* WasmModule::loadFromSourcePath(const std::string& path) {
     if (data.empty()) return nullptr;
 
     auto* instance = new WasmModule();
-    if (!instance->initCommon()) { delete instance; return nullptr; }
+    if (!instance->initCommon(config)) { delete instance; return nullptr; }
 
     LOGI("JIT Compiling from path... size=%zu", data.size());
 
     // 2. 编译
-    wasmtime_error_t* err = wasmtime_module_new(instance->engine, data.data(), data.size(), &instance->module);
-    if (err) {
-        wasm_byte_vec_t msg;
-        wasmtime_error_message(err, &msg);
-        LOGE("Compile failed: %s", msg.data);
-        wasm_byte_vec_delete(&msg);
-        wasmtime_error_delete(err);
-        delete instance;
-        return nullptr;
-    }
+    if (!instance->compileSource(data.data(), data.size())) { delete instance; return nullptr; }
+
+    // 导入未能全部解析时加载失败，避免为一个无法调用的模块写出 .cwasm 缓存
+    if (!instance->finishLoad(deferImports)) { delete instance; return nullptr; }
 
     LOGI("JIT (Path) Success. Time: %lld ms", (current_ms() - start));
     return instance;
 }
 
 bool WasmModule::saveCacheToPath(const std::string& path) {
+    return writeCache(module, hasSourceHash, sourceHash, configFingerprint, path);
+}
+
+bool WasmModule::writeCache(const std::shared_ptr<wasmtime_module_t>& module, bool hasSourceHash, uint64_t sourceHash,
+                            uint64_t configFingerprint, const std::string& path) {
     if (!module) return false;
 
     LOGI("Serializing module...");
     wasm_byte_vec_t serialized;
-    wasmtime_error_t* err = wasmtime_module_serialize(module, &serialized);
+    wasmtime_error_t* err = wasmtime_module_serialize(module.get(), &serialized);
 
     if (err) {
         wasm_byte_vec_t msg;
@@ -165,16 +313,148 @@ bool WasmModule::saveCacheToPath(const std::string& path) {
         return false;
     }
 
-    // 转换为 vector 并写入
-    std::vector<uint8_t> data(serialized.data, serialized.data + serialized.size);
-    wasm_byte_vec_delete(&serialized);
+    // 先移除旧的缓存头，保证 "头存在" 意味着与之匹配的 .cwasm 已经完整落盘
+    WasmModuleCache::removeHeader(path);
 
-    bool success = JniUtils::writeFile(path, data);
-    LOGI("Cache saved to %s (size: %zu, success: %d)", path.c_str(), data.size(), success);
+    // 直接从 Wasmtime 的缓冲区写入临时文件，fsync 后 rename 到目标路径
+    std::string error;
+    bool success = JniUtils::writeFileAtomic(path, (const uint8_t*)serialized.data, serialized.size, &error);
+    if (success) {
+        LOGI("Cache saved to %s (size: %zu)", path.c_str(), serialized.size);
+        if (hasSourceHash) {
+            WasmModuleCache::writeHeader(path, sourceHash, configFingerprint, serialized.size);
+        }
+    } else {
+        LOGE("Cache save failed: %s", error.c_str());
+    }
+    wasm_byte_vec_delete(&serialized);
     return success;
 }
 
+bool WasmModule::defineImport(const std::string& moduleName, const std::string& name,
+                              const std::vector<wasm_valkind_t>& params, const std::vector<wasm_valkind_t>& results,
+                              wasmtime_func_callback_t callback, void* env) {
+    // C API 的 Linker 不支持叠加，overlay 即一份带全部内置定义的私有 Linker
+    if (!ownsLinker) {
+        linker = WasmEngineRegistry::createBaseLinker(engine);
+        ownsLinker = true;
+    }
+    if (!WasmExecutor::defineFunction(linker, moduleName, name, callback, params, results, env)) return false;
+    if (!initInstancePre()) return false;
+    capturePureDeclarations();
+    return true;
+}
+
 std::string WasmModule::call(const std::string& action, const std::string& json) {
-    WasmExecutor exec(this, action, json);
-    return exec.run();
+    std::string out;
+    call(std::string_view(action), std::string_view(json), out, -1, nullptr);
+    return out;
+}
+
+void WasmModule::call(std::string_view action, std::string_view json, std::string& out) {
+    call(action, json, out, -1, nullptr);
+}
+
+std::string WasmModule::call(const std::string& action, const std::string& json, int64_t timeoutMs,
+                             const std::shared_ptr<WasmCancelToken>& cancelToken) {
+    std::string out;
+    call(std::string_view(action), std::string_view(json), out, timeoutMs, cancelToken);
+    return out;
+}
+
+void WasmModule::call(std::string_view action, std::string_view json, std::string& out, int64_t timeoutMs,
+                      const std::shared_ptr<WasmCancelToken>& cancelToken) {
+    // 纯函数 action 命中结果缓存时直接返回
+    bool cacheEnabled = resultCache.isEnabled();
+    if (cacheEnabled && resultCache.isPure(action) && resultCache.lookup(action, json, out)) return;
+
+    WasmExecutor exec(this);
+    exec.setDeadline(timeoutMs, cancelToken);
+    exec.run(action, json, out);
+
+    // Guest 可能在本次 _initialize 中才声明纯函数，这里重新判断
+    if (cacheEnabled && resultCache.isPure(action)) resultCache.store(action, json, out);
+}
+
+void WasmModule::callBatch(const std::vector<std::pair<std::string_view, std::string_view>>& items,
+                           std::vector<std::string>& results) {
+    results.resize(items.size());
+    std::unique_ptr<WasmExecutor> exec;
+    for (size_t i = 0; i < items.size(); ++i) {
+        // 首项或上一项 Trap 后 (实例状态不可信) 重新实例化
+        if (!exec || exec->isPoisoned()) {
+            exec = std::make_unique<WasmExecutor>(this);
+            if (!exec->instantiate(results[i])) {
+                // 实例化失败与输入无关，剩余各项返回同一个错误
+                for (size_t j = i + 1; j < items.size(); ++j) results[j] = results[i];
+                return;
+            }
+        }
+        exec->dispatch(items[i].first, items[i].second, results[i]);
+    }
+}
+
+std::shared_ptr<const WasmCallConfig> WasmModule::getCallConfig() const {
+    std::lock_guard<std::mutex> guard(callConfigLock);
+    return callConfig;
+}
+
+template <typename Fn>
+void WasmModule::updateCallConfig(Fn&& fn) {
+    std::lock_guard<std::mutex> guard(callConfigLock);
+    auto next = std::make_shared<WasmCallConfig>(*callConfig);
+    fn(*next);
+    callConfig = std::move(next);
+}
+
+void WasmModule::setCallLimits(const WasmStoreLimits& limits) {
+    updateCallConfig([&](WasmCallConfig& config) { config.limits = limits; });
+}
+
+void WasmModule::setLogTag(const std::string& tag) {
+    updateCallConfig([&](WasmCallConfig& config) { config.logTag = tag; });
+}
+
+void WasmModule::setWasiPolicy(const WasmWasiPolicy& policy) {
+    // 新策略在锁外构造好 (allowEnv 等已在调用方完成)，锁内只替换指针
+    auto wasi = std::make_shared<const WasmWasiPolicy>(policy);
+    updateCallConfig([&](WasmCallConfig& config) { config.wasi = std::move(wasi); });
+}
+
+bool WasmModule::setSampling(bool enabled, int64_t intervalMs) {
+    if (enabled && !epochInterruption) {
+        LOGE("Sampling requires an engine with epoch interruption");
+        return false;
+    }
+    std::lock_guard<std::mutex> guard(samplingLock);
+    if (enabled) {
+        if (!sampler) sampler = std::make_unique<WasmSampler>(engine, module.get(), intervalMs);
+        else sampler->setInterval(intervalMs);
+    }
+    samplingEnabled.store(enabled, std::memory_order_release);
+    LOGI("Sampling %s (interval=%lld ms)", enabled ? "enabled" : "disabled", (long long)intervalMs);
+    return true;
+}
+
+bool WasmModule::callAsync(std::string action, std::string json, int64_t timeoutMs,
+                           std::shared_ptr<WasmCancelToken> cancelToken, AsyncCallback done) {
+    {
+        std::lock_guard<std::mutex> guard(asyncLock);
+        ++asyncPending;
+    }
+    bool submitted = WasmWorkerPool::shared().submit(
+            [this, action = std::move(action), json = std::move(json), timeoutMs,
+             cancelToken = std::move(cancelToken), done = std::move(done)] {
+                std::string result;
+                call(std::string_view(action), std::string_view(json), result, timeoutMs, cancelToken);
+                // 回调返回后才归还计数: 析构返回时不会还有回调在执行；归还之后不能再访问 this
+                done(result);
+                std::lock_guard<std::mutex> guard(asyncLock);
+                if (--asyncPending == 0) asyncIdle.notify_all();
+            });
+    if (!submitted) {
+        std::lock_guard<std::mutex> guard(asyncLock);
+        if (--asyncPending == 0) asyncIdle.notify_all();
+    }
+    return submitted;
 }
\ No newline at end of file
@@ -0,0 +1,104 @@
+#include "WasmModuleCache.h"
+#include "JniUtils.h"
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <unistd.h>
+
+static const char kHeaderMagic[4] = {'W', 'L', 'C', 'W'};
+static const uint32_t kHeaderVersion = 1;
+
+// 进程内缓存: 只持有弱引用，最后一个 WasmModule 释放后模块随之释放
+static std::mutex g_cacheLock;
+static std::map<std::pair<uint64_t, uint64_t>, std::weak_ptr<wasmtime_module_t>> g_modules;
+
+uint64_t WasmModuleCache::hashBytes(const void* data, size_t size, uint64_t seed) {
+    const uint64_t m = 0xc6a4a7935bd1e995ULL;
+    const int r = 47;
+    uint64_t h = seed ^ (size * m);
+
+    auto* p = static_cast<const uint8_t*>(data);
+    const uint8_t* end = p + (size / 8) * 8;
+    for (; p != end; p += 8) {
+        uint64_t k;
+        memcpy(&k, p, 8);
+        k *= m;
+        k ^= k >> r;
+        k *= m;
+        h ^= k;
+        h *= m;
+    }
+
+    switch (size & 7) {
+        case 7: h ^= uint64_t(p[6]) << 48; [[fallthrough]];
+        case 6: h ^= uint64_t(p[5]) << 40; [[fallthrough]];
+        case 5: h ^= uint64_t(p[4]) << 32; [[fallthrough]];
+        case 4: h ^= uint64_t(p[3]) << 24; [[fallthrough]];
+        case 3: h ^= uint64_t(p[2]) << 16; [[fallthrough]];
+        case 2: h ^= uint64_t(p[1]) << 8; [[fallthrough]];
+        case 1: h ^= uint64_t(p[0]); h *= m;
+    }
+
+    h ^= h >> r;
+    h *= m;
+    h ^= h >> r;
+    return h;
+}
+
+WasmModuleCache::ModuleRef WasmModuleCache::find(uint64_t sourceHash, uint64_t engineKey) {
+    std::lock_guard<std::mutex> guard(g_cacheLock);
+    auto it = g_modules.find({sourceHash, engineKey});
+    if (it == g_modules.end()) return nullptr;
+    return it->second.lock();
+}
+
+WasmModuleCache::ModuleRef WasmModuleCache::put(uint64_t sourceHash, uint64_t engineKey, wasmtime_module_t* module) {
+    std::lock_guard<std::mutex> guard(g_cacheLock);
+
+    // 顺手清理已经失效的条目
+    for (auto it = g_modules.begin(); it != g_modules.end();) {
+        if (it->second.expired()) it = g_modules.erase(it);
+        else ++it;
+    }
+
+    auto& slot = g_modules[{sourceHash, engineKey}];
+    if (auto existing = slot.lock()) {
+        wasmtime_module_delete(module);
+        return existing;
+    }
+    ModuleRef ref(module, wasmtime_module_delete);
+    slot = ref;
+    return ref;
+}
+
+std::string WasmModuleCache::headerPath(const std::string& cachePath) {
+    return cachePath + ".meta";
+}
+
+bool WasmModuleCache::readHeader(const std::string& cachePath, WasmCacheHeader& header) {
+    std::ifstream file(headerPath(cachePath), std::ios::binary);
+    if (!file) return false;
+    if (!file.read((char*)&header, sizeof(header))) return false;
+    return memcmp(header.magic, kHeaderMagic, 4) == 0 && header.version == kHeaderVersion;
+}
+
+bool WasmModuleCache::writeHeader(const std::string& cachePath, uint64_t sourceHash, uint64_t fingerprint, uint64_t payloadSize) {
+    WasmCacheHeader header{};
+    memcpy(header.magic, kHeaderMagic, 4);
+    header.version = kHeaderVersion;
+    header.sourceHash = sourceHash;
+    header.configFingerprint = fingerprint;
+    header.payloadSize = payloadSize;
+
+    std::string error;
+    if (!JniUtils::writeFileAtomic(headerPath(cachePath), (const uint8_t*)&header, sizeof(header), &error)) {
+        LOGE("Cache header save failed: %s", error.c_str());
+        return false;
+    }
+    return true;
+}
+
+void WasmModuleCache::removeHeader(const std::string& cachePath) {
+    unlink(headerPath(cachePath).c_str());
+}
\ No newline at end of file
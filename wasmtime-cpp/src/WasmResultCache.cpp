@@ -0,0 +1,123 @@
+#include "WasmResultCache.h"
+#include "WasmModuleCache.h"
+
+uint64_t WasmResultCache::keyOf(std::string_view action, std::string_view json) {
+    // action 的哈希作为 json 哈希的种子，("ab", "c") 与 ("a", "bc") 不会得到同一个键
+    uint64_t seed = WasmModuleCache::hashBytes(action.data(), action.size());
+    return WasmModuleCache::hashBytes(json.data(), json.size(), seed);
+}
+
+void WasmResultCache::configure(size_t bytes, int64_t ttl) {
+    std::lock_guard<std::mutex> guard(lock);
+    maxBytes = bytes;
+    ttlMs = ttl;
+    lru.clear();
+    index.clear();
+    usedBytes = 0;
+    enabled.store(bytes > 0, std::memory_order_relaxed);
+}
+
+void WasmResultCache::declarePure(std::string_view action) {
+    {
+        // Guest 每次 _initialize 都会重新声明，已登记时只走读锁
+        std::shared_lock<std::shared_mutex> guard(pureLock);
+        if (pureActions.find(action) != pureActions.end()) return;
+    }
+    std::unique_lock<std::shared_mutex> guard(pureLock);
+    if (pureActions.emplace(action).second) {
+        LOGI("Action declared pure: %.*s", (int)action.size(), action.data());
+    }
+}
+
+bool WasmResultCache::isPure(std::string_view action) const {
+    std::shared_lock<std::shared_mutex> guard(pureLock);
+    return pureActions.find(action) != pureActions.end();
+}
+
+bool WasmResultCache::lookup(std::string_view action, std::string_view json, std::string& out) {
+    uint64_t key = keyOf(action, json);
+    std::lock_guard<std::mutex> guard(lock);
+    auto it = index.find(key);
+    if (it == index.end()) {
+        missCount.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    Entry& entry = *it->second;
+    bool expired = ttlMs > 0 && Clock::now() >= entry.expiresAt;
+    if (expired || entry.action != action || entry.json != json) {
+        if (expired) {
+            usedBytes -= entry.size();
+            lru.erase(it->second);
+            index.erase(it);
+        }
+        missCount.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    // 移到表头，拷贝结果 (out 复用已有容量)
+    lru.splice(lru.begin(), lru, it->second);
+    out.assign(entry.result);
+    hitCount.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+void WasmResultCache::store(std::string_view action, std::string_view json, const std::string& result) {
+    if (result.compare(0, 8, "{\"error\"") == 0) return;
+
+    uint64_t key = keyOf(action, json);
+    std::lock_guard<std::mutex> guard(lock);
+    if (maxBytes == 0) return;
+
+    auto it = index.find(key);
+    if (it != index.end()) {
+        usedBytes -= it->second->size();
+        lru.erase(it->second);
+        index.erase(it);
+    }
+
+    Entry entry{key, std::string(action), std::string(json), result, Clock::time_point()};
+    if (ttlMs > 0) entry.expiresAt = Clock::now() + std::chrono::milliseconds(ttlMs);
+    // 单条超过总容量的不缓存
+    if (entry.size() > maxBytes) return;
+
+    usedBytes += entry.size();
+    lru.push_front(std::move(entry));
+    index[key] = lru.begin();
+    evictLocked();
+}
+
+void WasmResultCache::evictLocked() {
+    while (usedBytes > maxBytes && !lru.empty()) {
+        Entry& oldest = lru.back();
+        usedBytes -= oldest.size();
+        index.erase(oldest.key);
+        lru.pop_back();
+        evictionCount.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void WasmResultCache::clear() {
+    std::lock_guard<std::mutex> guard(lock);
+    lru.clear();
+    index.clear();
+    usedBytes = 0;
+}
+
+size_t WasmResultCache::bytes() const {
+    std::lock_guard<std::mutex> guard(lock);
+    return usedBytes;
+}
+
+std::string WasmResultCache::statsJson() const {
+    size_t entries, used;
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        entries = lru.size();
+        used = usedBytes;
+    }
+    return "{\"enabled\": " + std::string(isEnabled() ? "true" : "false") +
+           ", \"hits\": " + std::to_string(hits()) +
+           ", \"misses\": " + std::to_string(misses()) +
+           ", \"evictions\": " + std::to_string(evictions()) +
+           ", \"entries\": " + std::to_string(entries) +
+           ", \"bytes\": " + std::to_string(used) + "}";
+}
@@ -0,0 +1,135 @@
+#include "WasmSampler.h"
+#include <cstring>
+
+namespace {
+    const char* const kPhaseNames[(int)WasmSampler::Phase::Count] = {"instantiate", "initialize", "run"};
+
+#ifdef WASMTIME_FEATURE_PROFILING
+    // 借用字符串构造 wasm_name_t (GuestProfiler 会自行拷贝)
+    wasm_name_t borrowName(std::string_view value) {
+        wasm_name_t name;
+        name.size = value.size();
+        name.data = const_cast<char*>(value.data());
+        return name;
+    }
+#endif
+}
+
+WasmSampler::WasmSampler(wasm_engine_t* e, const wasmtime_module_t* m, int64_t intervalMs)
+        : intervalNs(intervalMs * 1000000) {
+#ifdef WASMTIME_FEATURE_PROFILING
+    engine = e;
+    module = m;
+#else
+    LOGI("libwasmtime built without profiling, sampler only records action;phase counts");
+#endif
+}
+
+WasmSampler::~WasmSampler() {
+#ifdef WASMTIME_FEATURE_PROFILING
+    for (auto& entry : entries) {
+        if (entry->profiler) wasmtime_guestprofiler_delete(entry->profiler);
+    }
+#endif
+}
+
+void WasmSampler::restartProfiler(Entry& entry) {
+#ifdef WASMTIME_FEATURE_PROFILING
+    if (entry.profiler) wasmtime_guestprofiler_delete(entry.profiler);
+    wasm_name_t moduleName = borrowName("plugin");
+    wasmtime_guestprofiler_modules_t modules{&moduleName, module};
+    wasm_name_t profileName = borrowName(entry.action);
+    entry.profiler = wasmtime_guestprofiler_new(engine, &profileName, (uint64_t)getIntervalNs(), &modules, 1);
+#endif
+}
+
+WasmSampler::Entry* WasmSampler::findOrCreate(std::string_view action) {
+    auto find = [&](std::string_view name) -> Entry* {
+        for (const auto& entry : entries) {
+            if (entry->action == name) return entry.get();
+        }
+        return nullptr;
+    };
+    {
+        std::shared_lock<std::shared_mutex> guard(lock);
+        if (Entry* entry = find(action)) return entry;
+    }
+    std::unique_lock<std::shared_mutex> guard(lock);
+    if (Entry* entry = find(action)) return entry;
+    if (entries.size() >= kMaxActions) {
+        if (Entry* other = find("_other")) return other;
+        action = "_other";
+    }
+    auto entry = std::make_unique<Entry>();
+    entry->action = std::string(action);
+    restartProfiler(*entry);
+    entries.push_back(std::move(entry));
+    return entries.back().get();
+}
+
+void WasmSampler::sample(std::string_view action, Phase phase, wasmtime_store_t* store, uint64_t deltaNs) {
+    Entry* entry = findOrCreate(action);
+    std::lock_guard<std::mutex> guard(entry->lock);
+    entry->counts[(int)phase]++;
+#ifdef WASMTIME_FEATURE_PROFILING
+    if (entry->profiler) wasmtime_guestprofiler_sample(entry->profiler, store, deltaNs);
+#endif
+}
+
+std::string WasmSampler::folded() const {
+    std::string out;
+    std::shared_lock<std::shared_mutex> guard(lock);
+    for (const auto& entry : entries) {
+        std::lock_guard<std::mutex> entryGuard(entry->lock);
+        for (int i = 0; i < (int)Phase::Count; ++i) {
+            if (entry->counts[i] == 0) continue;
+            out += entry->action + ";" + kPhaseNames[i] + " " + std::to_string(entry->counts[i]) + "\n";
+        }
+    }
+    return out;
+}
+
+std::string WasmSampler::firefoxProfile(std::string_view action) {
+#ifdef WASMTIME_FEATURE_PROFILING
+    Entry* entry = nullptr;
+    {
+        std::shared_lock<std::shared_mutex> guard(lock);
+        for (const auto& e : entries) {
+            if (e->action == action) entry = e.get();
+        }
+    }
+    if (!entry) return "{\"error\": \"No Samples\"}";
+
+    std::lock_guard<std::mutex> guard(entry->lock);
+    if (!entry->profiler) return "{\"error\": \"Profiler Unavailable\"}";
+
+    // finish 会消耗掉 GuestProfiler，导出后换一个新的继续采集
+    wasm_byte_vec_t json;
+    wasmtime_error_t* err = wasmtime_guestprofiler_finish(entry->profiler, &json);
+    entry->profiler = nullptr;
+    restartProfiler(*entry);
+    memset(entry->counts, 0, sizeof(entry->counts));
+    if (err) {
+        wasm_byte_vec_t msg;
+        wasmtime_error_message(err, &msg);
+        LOGE("Guest profile export failed: %s", msg.data);
+        wasm_byte_vec_delete(&msg);
+        wasmtime_error_delete(err);
+        return "{\"error\": \"Profile Export Failed\"}";
+    }
+    std::string out(json.data, json.size);
+    wasm_byte_vec_delete(&json);
+    return out;
+#else
+    return "{\"error\": \"Profiling Unsupported\"}";
+#endif
+}
+
+void WasmSampler::reset() {
+    std::shared_lock<std::shared_mutex> guard(lock);
+    for (auto& entry : entries) {
+        std::lock_guard<std::mutex> entryGuard(entry->lock);
+        memset(entry->counts, 0, sizeof(entry->counts));
+        restartProfiler(*entry);
+    }
+}
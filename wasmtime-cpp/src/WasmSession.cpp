@@ -0,0 +1,46 @@
+#include "WasmSession.h"
+#include "WasmModule.h"
+#include "WasmExecutor.h"
+
+WasmSession::WasmSession(WasmModule* m, const WasmStoreLimits& l) : holder(m), limits(l) {}
+
+WasmSession::~WasmSession() = default;
+
+WasmSession* WasmSession::open(WasmModule* module) {
+    if (!module) return nullptr;
+    return open(module, module->getCallLimits());
+}
+
+WasmSession* WasmSession::open(WasmModule* module, const WasmStoreLimits& limits) {
+    if (!module) return nullptr;
+
+    auto* session = new WasmSession(module, limits);
+    session->executor = std::make_unique<WasmExecutor>(module, limits);
+
+    std::string error;
+    if (!session->executor->instantiate(error)) {
+        LOGE("Session open failed: %s", error.c_str());
+        delete session;
+        return nullptr;
+    }
+    return session;
+}
+
+std::string WasmSession::call(const std::string& action, const std::string& json, int64_t timeoutMs,
+                              const std::shared_ptr<WasmCancelToken>& cancelToken) {
+    std::lock_guard<std::mutex> guard(lock);
+
+    // 上一次调用 Trap 过，实例状态不可信，重建 Store 和 Instance
+    if (!executor || executor->isPoisoned()) {
+        LOGI("Session instance poisoned, re-instantiating...");
+        executor = std::make_unique<WasmExecutor>(holder, limits);
+        executor->setDeadline(timeoutMs, cancelToken);
+        std::string error;
+        if (!executor->instantiate(error)) {
+            executor.reset();
+            return error;
+        }
+    }
+    executor->setDeadline(timeoutMs, cancelToken);
+    return executor->dispatch(action, json);
+}
\ No newline at end of file
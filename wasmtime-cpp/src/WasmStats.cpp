@@ -0,0 +1,48 @@
+#include "WasmStats.h"
+
+namespace {
+    const char* const kCounterNames[(int)WasmCounter::Count] = {
+            "storeCreateNs", "storeCreateCount",
+            "instantiateNs", "instantiateCount",
+            "initializeNs", "initializeCount",
+            "runNs", "runCount",
+            "hostCalls", "bytesIn", "bytesOut",
+    };
+
+    std::atomic<int> g_nextShard{0};
+}
+
+int WasmStats::shardIndex() {
+    // 线程首次记账时轮流分配分片，之后固定不变
+    static thread_local int index = g_nextShard.fetch_add(1, std::memory_order_relaxed) % kShards;
+    return index;
+}
+
+WasmStatsSnapshot WasmStats::snapshot() const {
+    WasmStatsSnapshot out;
+    for (const Shard& shard : shards) {
+        for (int i = 0; i < (int)WasmCounter::Count; ++i) {
+            out.values[i] += shard.values[i].load(std::memory_order_relaxed);
+        }
+    }
+    return out;
+}
+
+void WasmStats::reset() {
+    for (Shard& shard : shards) {
+        for (auto& value : shard.values) value.store(0, std::memory_order_relaxed);
+    }
+}
+
+std::string WasmStatsSnapshot::toJson() const {
+    std::string json = "{";
+    for (int i = 0; i < (int)WasmCounter::Count; ++i) {
+        if (i > 0) json += ", ";
+        json += "\"";
+        json += kCounterNames[i];
+        json += "\": ";
+        json += std::to_string(values[i]);
+    }
+    json += "}";
+    return json;
+}
@@ -0,0 +1,105 @@
+#include "WasmWasiPolicy.h"
+#include "WasmLogSink.h"
+#include <cstdlib>
+
+WasmWasiPolicy::WasmWasiPolicy(const WasmWasiPolicy& other)
+        : env(other.env), args(other.args), preopens(other.preopens), stdio(other.stdio) {
+    flatten();
+}
+
+WasmWasiPolicy& WasmWasiPolicy::operator=(const WasmWasiPolicy& other) {
+    if (this == &other) return *this;
+    env = other.env;
+    args = other.args;
+    preopens = other.preopens;
+    stdio = other.stdio;
+    flatten();
+    return *this;
+}
+
+WasmWasiPolicy& WasmWasiPolicy::setEnv(const std::string& name, const std::string& value) {
+    bool replaced = false;
+    for (auto& entry : env) {
+        if (entry.first == name) {
+            entry.second = value;
+            replaced = true;
+            break;
+        }
+    }
+    if (!replaced) env.emplace_back(name, value);
+    flatten();
+    return *this;
+}
+
+WasmWasiPolicy& WasmWasiPolicy::allowEnv(const std::vector<std::string>& names) {
+    for (const auto& name : names) {
+        const char* value = getenv(name.c_str());
+        if (value) setEnv(name, value);
+    }
+    return *this;
+}
+
+WasmWasiPolicy& WasmWasiPolicy::setArgs(const std::vector<std::string>& values) {
+    args = values;
+    flatten();
+    return *this;
+}
+
+WasmWasiPolicy& WasmWasiPolicy::addPreopen(const std::string& hostPath, const std::string& guestPath, bool readOnly) {
+    preopens.push_back({hostPath, guestPath, readOnly});
+    return *this;
+}
+
+void WasmWasiPolicy::flatten() {
+    envNames.clear();
+    envValues.clear();
+    argv.clear();
+    for (const auto& entry : env) {
+        envNames.push_back(entry.first.c_str());
+        envValues.push_back(entry.second.c_str());
+    }
+    for (const auto& arg : args) argv.push_back(arg.c_str());
+}
+
+wasi_config_t* WasmWasiPolicy::build(WasmLogTarget* logTarget) const {
+    wasi_config_t* wasi = wasi_config_new();
+    if (!envNames.empty()) {
+        wasi_config_set_env(wasi, envNames.size(), const_cast<const char**>(envNames.data()),
+                            const_cast<const char**>(envValues.data()));
+    }
+    if (!argv.empty()) wasi_config_set_argv(wasi, argv.size(), const_cast<const char**>(argv.data()));
+
+    for (const auto& dir : preopens) {
+        wasi_dir_perms dirPerms = WASMTIME_WASI_DIR_PERMS_READ;
+        wasi_file_perms filePerms = WASMTIME_WASI_FILE_PERMS_READ;
+        if (!dir.readOnly) {
+            dirPerms |= WASMTIME_WASI_DIR_PERMS_WRITE;
+            filePerms |= WASMTIME_WASI_FILE_PERMS_WRITE;
+        }
+        if (!wasi_config_preopen_dir(wasi, dir.hostPath.c_str(), dir.guestPath.c_str(), dirPerms, filePerms)) {
+            LOGE("WASI preopen failed: %s -> %s", dir.hostPath.c_str(), dir.guestPath.c_str());
+            wasi_config_delete(wasi);
+            return nullptr;
+        }
+    }
+
+    switch (stdio) {
+        case Stdio::LogSink:
+#ifndef WASMLINE_LOG_STRIP
+            // Guest 输出只拷进异步日志队列，不在 Wasm 线程上做格式化与系统调用
+            if (logTarget) {
+                wasi_config_set_stdout_custom(wasi, WasmLogSink::wasiStdout, logTarget, nullptr);
+                wasi_config_set_stderr_custom(wasi, WasmLogSink::wasiStderr, logTarget, nullptr);
+            }
+#endif
+            break;
+        case Stdio::Inherit:
+            wasi_config_inherit_stdout(wasi);
+            wasi_config_inherit_stderr(wasi);
+            break;
+        case Stdio::Discard:
+            // wasi_config_t 默认即丢弃输出
+            break;
+    }
+    return wasi;
+}
@@ -0,0 +1,53 @@
+#include "WasmWorkerPool.h"
+#include <thread>
+
+// 队列容量 (2 的幂)，超过即视为过载，直接拒绝
+static constexpr size_t kQueueCapacity = 1024;
+
+static thread_local bool t_isWorker = false;
+
+bool WasmWorkerPool::isWorkerThread() {
+    return t_isWorker;
+}
+
+WasmWorkerPool& WasmWorkerPool::shared() {
+    static WasmWorkerPool* pool = [] {
+        size_t cores = std::thread::hardware_concurrency();
+        return new WasmWorkerPool(cores > 0 ? cores : 1, kQueueCapacity);
+    }();
+    return *pool;
+}
+
+WasmWorkerPool::WasmWorkerPool(size_t threads, size_t capacity) : queue(capacity), threadCount(0) {
+    for (size_t i = 0; i < threads; ++i) {
+        try {
+            std::thread([this] { workerLoop(); }).detach();
+            ++threadCount;
+        } catch (const std::system_error& e) {
+            LOGE("Failed to start wasm worker: %s", e.what());
+        }
+    }
+    LOGI("Wasm worker pool started: %zu threads", threadCount);
+}
+
+bool WasmWorkerPool::submit(Task task) {
+    if (threadCount == 0 || !queue.push(std::move(task))) return false;
+    // 先拿一下锁再通知: 保证正在判空准备休眠的线程不会错过这次唤醒
+    { std::lock_guard<std::mutex> guard(sleepLock); }
+    wakeup.notify_one();
+    return true;
+}
+
+void WasmWorkerPool::workerLoop() {
+    t_isWorker = true;
+    Task task;
+    while (true) {
+        if (queue.pop(task)) {
+            task();
+            task = nullptr;
+            continue;
+        }
+        std::unique_lock<std::mutex> guard(sleepLock);
+        wakeup.wait(guard, [this] { return !queue.empty(); });
+    }
+}
\ No newline at end of file
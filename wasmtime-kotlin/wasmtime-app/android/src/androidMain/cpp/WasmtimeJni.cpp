@@ -1,16 +1,172 @@
 #include <jni.h>
+#include <cstring>
 #include <string>
 #include <vector>
 #include "WasmModule.h"
+#include "WasmSession.h"
+#include "WasmLoadTask.h"
+#include "WasmEpochTicker.h"
+#include "WasmWorkerPool.h"
+
+static JavaVM* g_vm = nullptr;
+
+// JNI_OnLoad 时解析并缓存的类与方法 (类为全局引用，常驻进程)，热路径上不再 FindClass / GetMethodID
+static jclass g_stringClass = nullptr;
+static jclass g_byteBufferClass = nullptr;
+static jmethodID g_bufferLimit = nullptr;          // Buffer.limit(int)
+static jmethodID g_allocateDirect = nullptr;       // ByteBuffer.allocateDirect(int)
+static jmethodID g_callCallbackComplete = nullptr; // WasmCallCallback.onNativeComplete(String)
+static jmethodID g_loadTaskComplete = nullptr;     // WasmLoadTask.onNativeComplete(long)
+
+static jclass findGlobalClass(JNIEnv* env, const char* name) {
+    jclass local = env->FindClass(name);
+    if (!local) {
+        env->ExceptionClear();
+        LOGE("JNI class not found: %s", name);
+        return nullptr;
+    }
+    auto global = static_cast<jclass>(env->NewGlobalRef(local));
+    env->DeleteLocalRef(local);
+    return global;
+}
+
+static jmethodID findMethod(JNIEnv* env, jclass cls, const char* name, const char* sig, bool isStatic = false) {
+    if (!cls) return nullptr;
+    jmethodID method = isStatic ? env->GetStaticMethodID(cls, name, sig) : env->GetMethodID(cls, name, sig);
+    if (!method) {
+        env->ExceptionClear();
+        LOGE("JNI method not found: %s%s", name, sig);
+    }
+    return method;
+}
+
+// 在 Native 工作线程上回调 Java: 未挂载的线程临时挂载，用完即卸载
+// keepAttached: 常驻线程 (如 WasmWorkerPool) 以守护线程方式挂载后不再卸载，省去每次回调的挂载开销
+template <typename Fn>
+static void withJniEnv(Fn&& fn, bool keepAttached = false) {
+    if (!g_vm) return;
+    JNIEnv* env = nullptr;
+    bool attached = false;
+    if (g_vm->GetEnv(reinterpret_cast<void**>(&env), JNI_VERSION_1_6) == JNI_EDETACHED) {
+        jint status = keepAttached ? g_vm->AttachCurrentThreadAsDaemon(&env, nullptr)
+                                   : g_vm->AttachCurrentThread(&env, nullptr);
+        if (status != JNI_OK) return;
+        attached = !keepAttached;
+    }
+    fn(env);
+    if (env->ExceptionCheck()) env->ExceptionClear();
+    if (attached) g_vm->DetachCurrentThread();
+}
+
+// 按 Profile 名解析引擎配置，null / 未知名字回退到平台默认 Profile
+static WasmConfig toConfig(JNIEnv* env, jstring profileStr) {
+    WasmConfig config = WasmConfig::defaultProfile();
+    if (!profileStr) return config;
+    const char* profile = env->GetStringUTFChars(profileStr, nullptr);
+    if (!WasmConfig::fromName(profile, config)) {
+        LOGE("Unknown wasm profile: %s, fallback to %s", profile, config.getName().c_str());
+    }
+    env->ReleaseStringUTFChars(profileStr, profile);
+    return config;
+}
+
+// Store 资源上限: [memorySize, tableElements, instances, tables, memories]，-1 表示不限制
+static WasmStoreLimits toLimits(JNIEnv* env, jlongArray array) {
+    WasmStoreLimits limits;
+    if (!array || env->GetArrayLength(array) < 5) return limits;
+    jlong v[5];
+    env->GetLongArrayRegion(array, 0, 5, v);
+    limits.memorySize = v[0];
+    limits.tableElements = v[1];
+    limits.instances = v[2];
+    limits.tables = v[3];
+    limits.memories = v[4];
+    return limits;
+}
+
+// String[] -> vector<string>，null 数组或元素视为空
+static std::vector<std::string> toStrings(JNIEnv* env, jobjectArray array) {
+    std::vector<std::string> out;
+    jsize count = array ? env->GetArrayLength(array) : 0;
+    out.reserve(count);
+    for (jsize i = 0; i < count; ++i) {
+        auto str = static_cast<jstring>(env->GetObjectArrayElement(array, i));
+        const char* c = str ? env->GetStringUTFChars(str, nullptr) : nullptr;
+        out.emplace_back(c ? c : "");
+        if (c) env->ReleaseStringUTFChars(str, c);
+        if (str) env->DeleteLocalRef(str);
+    }
+    return out;
+}
+
+// 取消令牌句柄: 堆上的 shared_ptr，Native 调用期间各自持有引用，Java 先释放也不会悬空
+using CancelTokenRef = std::shared_ptr<WasmCancelToken>;
+
+static CancelTokenRef toCancelToken(jlong tokenHandle) {
+    auto* ref = reinterpret_cast<CancelTokenRef*>(tokenHandle);
+    return ref ? *ref : nullptr;
+}
+
+// 结果暂存区: 每个线程一块，复用容量；只在一次 JNI 调用内部使用，返回前已拷贝给 Java，不会外泄
+static thread_local std::string t_resultPool;
+
+// DirectByteBuffer 的 [offset, offset + length) 是否落在其容量之内
+static bool inDirectBuffer(JNIEnv* env, jobject buffer, jint offset, jint length) {
+    jlong capacity = env->GetDirectBufferCapacity(buffer);
+    return capacity >= 0 && offset >= 0 && length >= 0 && (jlong) offset + length <= capacity;
+}
+
+// 把结果拷贝进调用方提供的 DirectByteBuffer [offset, offset + capacity)，并把其 limit 设为结果末尾
+// out 为 null、不是 DirectByteBuffer、区间越界或剩余空间不足时，改为分配一块新的 DirectByteBuffer (归 JVM 管理)
+static jobject copyToDirectBuffer(JNIEnv* env, const std::string& data, jobject out, jint offset, jint capacity) {
+    auto* dst = out ? static_cast<char*>(env->GetDirectBufferAddress(out)) : nullptr;
+    if (dst && g_bufferLimit && inDirectBuffer(env, out, offset, capacity) && (size_t) capacity >= data.size()) {
+        memcpy(dst + offset, data.data(), data.size());
+        jobject self = env->CallObjectMethod(out, g_bufferLimit, (jint) (offset + data.size()));
+        if (self) env->DeleteLocalRef(self);
+        return out;
+    }
+
+    if (!g_allocateDirect) return nullptr;
+    jobject buffer = env->CallStaticObjectMethod(g_byteBufferClass, g_allocateDirect, (jint) data.size());
+    if (!buffer) return nullptr; // OutOfMemoryError 已抛给 Java
+    memcpy(env->GetDirectBufferAddress(buffer), data.data(), data.size());
+    return buffer;
+}
 
 extern "C" {
 
+JNIEXPORT jint JNICALL JNI_OnLoad(JavaVM* vm, void* reserved) {
+    g_vm = vm;
+    JNIEnv* env = nullptr;
+    if (vm->GetEnv(reinterpret_cast<void**>(&env), JNI_VERSION_1_6) != JNI_OK) return JNI_ERR;
+
+    g_stringClass = findGlobalClass(env, "java/lang/String");
+    g_byteBufferClass = findGlobalClass(env, "java/nio/ByteBuffer");
+    jclass bufferClass = env->FindClass("java/nio/Buffer");
+    g_bufferLimit = findMethod(env, bufferClass, "limit", "(I)Ljava/nio/Buffer;");
+    if (bufferClass) env->DeleteLocalRef(bufferClass);
+    g_allocateDirect = findMethod(env, g_byteBufferClass, "allocateDirect", "(I)Ljava/nio/ByteBuffer;", true);
+
+    // 回调类由本库的 Kotlin 代码定义，JNI_OnLoad 在其类加载器下执行，可以直接找到
+    jclass callbackClass = env->FindClass("crow/wasmtime/wasmline/WasmCallCallback");
+    g_callCallbackComplete = findMethod(env, callbackClass, "onNativeComplete", "(Ljava/lang/String;)V");
+    if (callbackClass) env->DeleteLocalRef(callbackClass);
+    else env->ExceptionClear();
+    jclass loadTaskClass = env->FindClass("crow/wasmtime/wasmline/WasmLoadTask");
+    g_loadTaskComplete = findMethod(env, loadTaskClass, "onNativeComplete", "(J)V");
+    if (loadTaskClass) env->DeleteLocalRef(loadTaskClass);
+    else env->ExceptionClear();
+    return JNI_VERSION_1_6;
+}
+
 // 1. 尝试从文件路径加载 (AOT)
 // 返回: handle 指针 (long), 0 表示失败
 JNIEXPORT jlong JNICALL
-Java_crow_wasmtime_wasmline_WasmEngine_nativeInitPath(JNIEnv *env, jobject thiz, jstring pathStr) {
+Java_crow_wasmtime_wasmline_WasmEngine_nativeInitPath(JNIEnv *env, jobject thiz, jstring pathStr, jstring profileStr) {
+    WasmConfig config = toConfig(env, profileStr);
     const char* path = env->GetStringUTFChars(pathStr, nullptr);
-    WasmModule* module = WasmModule::loadFromPath(path);
+    WasmModule* module = WasmModule::loadFromPath(path, config);
     env->ReleaseStringUTFChars(pathStr, path);
     return reinterpret_cast<jlong>(module);
 }
@@ -18,7 +174,7 @@ Java_crow_wasmtime_wasmline_WasmEngine_nativeInitPath(JNIEnv *env, jobject thiz,
 // 2. 从内存字节加载 (JIT)
 // 返回: handle 指针
 JNIEXPORT jlong JNICALL
-Java_crow_wasmtime_wasmline_WasmEngine_nativeInitBytes(JNIEnv *env, jobject thiz, jbyteArray bytes) {
+Java_crow_wasmtime_wasmline_WasmEngine_nativeInitBytes(JNIEnv *env, jobject thiz, jbyteArray bytes, jstring profileStr) {
     if (!bytes) return 0;
     jsize len = env->GetArrayLength(bytes);
     jbyte* data = env->GetByteArrayElements(bytes, nullptr);
@@ -26,15 +182,16 @@ Java_crow_wasmtime_wasmline_WasmEngine_nativeInitBytes(JNIEnv *env, jobject thiz
     std::vector<uint8_t> vec(data, data + len);
     env->ReleaseByteArrayElements(bytes, data, JNI_ABORT);
 
-    WasmModule* module = WasmModule::loadFromSource(vec);
+    WasmModule* module = WasmModule::loadFromSource(vec, toConfig(env, profileStr));
     return reinterpret_cast<jlong>(module);
 }
 
 // 从文件路径加载源码进行 JIT 编译
 JNIEXPORT jlong JNICALL
-Java_crow_wasmtime_wasmline_WasmEngine_nativeInitSourcePath(JNIEnv *env, jobject thiz, jstring pathStr) {
+Java_crow_wasmtime_wasmline_WasmEngine_nativeInitSourcePath(JNIEnv *env, jobject thiz, jstring pathStr, jstring profileStr) {
+    WasmConfig config = toConfig(env, profileStr);
     const char* path = env->GetStringUTFChars(pathStr, nullptr);
-    WasmModule* module = WasmModule::loadFromSourcePath(path);
+    WasmModule* module = WasmModule::loadFromSourcePath(path, config);
     env->ReleaseStringUTFChars(pathStr, path);
     return reinterpret_cast<jlong>(module);
 }
@@ -51,9 +208,10 @@ Java_crow_wasmtime_wasmline_WasmEngine_nativeSaveCache(JNIEnv *env, jobject thiz
     return success;
 }
 
-// 4. 执行调用
+// 4. 执行调用 (timeoutMs < 0 表示不限时，token 为 0 表示不可取消)
 JNIEXPORT jstring JNICALL
-Java_crow_wasmtime_wasmline_WasmEngine_nativeCall(JNIEnv *env, jobject thiz, jlong handle, jstring action, jstring json) {
+Java_crow_wasmtime_wasmline_WasmEngine_nativeCall(JNIEnv *env, jobject thiz, jlong handle, jstring action, jstring json,
+                                                  jlong timeoutMs, jlong token) {
     auto* module = reinterpret_cast<WasmModule*>(handle);
     if (!module) return env->NewStringUTF("{\"error\": \"Invalid Handle\"}");
 
@@ -61,7 +219,7 @@ Java_crow_wasmtime_wasmline_WasmEngine_nativeCall(JNIEnv *env, jobject thiz, jlo
     const char* j = env->GetStringUTFChars(json, nullptr);
 
     // 执行
-    std::string result = module->call(a ? a : "", j ? j : "");
+    std::string result = module->call(a ? a : "", j ? j : "", timeoutMs, toCancelToken(token));
 
     if (a) env->ReleaseStringUTFChars(action, a);
     if (j) env->ReleaseStringUTFChars(json, j);
@@ -69,11 +227,364 @@ Java_crow_wasmtime_wasmline_WasmEngine_nativeCall(JNIEnv *env, jobject thiz, jlo
     return env->NewStringUTF(result.c_str());
 }
 
+// 4.1 DirectByteBuffer 调用 (UTF-8)
+// 输入零拷贝: 直接借用 DirectByteBuffer 的内存 (区间先按容量校验)。
+// 输出有一次拷贝: Guest 分段写出的结果先累积在线程私有暂存区 (结果缓存、错误改写也都基于它)，
+// 调用结束后整体拷进调用方提供的 out [outOff, outOff + outCap)，放不下时分配新的 DirectByteBuffer。
+// 返回的缓冲区归调用方所有，不依赖任何线程私有状态
+JNIEXPORT jobject JNICALL
+Java_crow_wasmtime_wasmline_WasmEngine_nativeCallBuffer(JNIEnv *env, jobject thiz, jlong handle,
+                                                        jobject action, jint actionOff, jint actionLen,
+                                                        jobject json, jint jsonOff, jint jsonLen,
+                                                        jobject out, jint outOff, jint outCap) {
+    auto* module = reinterpret_cast<WasmModule*>(handle);
+    auto* a = action ? static_cast<const char*>(env->GetDirectBufferAddress(action)) : nullptr;
+    auto* j = json ? static_cast<const char*>(env->GetDirectBufferAddress(json)) : nullptr;
+
+    if (!module) {
+        t_resultPool = "{\"error\": \"Invalid Handle\"}";
+    } else if ((action && !a) || (json && !j)) {
+        t_resultPool = "{\"error\": \"Not a direct buffer\"}";
+    } else if ((a && !inDirectBuffer(env, action, actionOff, actionLen)) ||
+               (j && !inDirectBuffer(env, json, jsonOff, jsonLen))) {
+        t_resultPool = "{\"error\": \"Buffer Out Of Range\"}";
+    } else {
+        module->call(std::string_view(a ? a + actionOff : "", a ? actionLen : 0),
+                     std::string_view(j ? j + jsonOff : "", j ? jsonLen : 0),
+                     t_resultPool);
+    }
+    return copyToDirectBuffer(env, t_resultPool, out, outOff, outCap);
+}
+
+// 4.2 字节数组调用 (UTF-8)，避免 jstring 的 Modified UTF-8 转换
+JNIEXPORT jbyteArray JNICALL
+Java_crow_wasmtime_wasmline_WasmEngine_nativeCallBytes(JNIEnv *env, jobject thiz, jlong handle, jbyteArray action, jbyteArray json) {
+    auto* module = reinterpret_cast<WasmModule*>(handle);
+    if (!module) {
+        t_resultPool = "{\"error\": \"Invalid Handle\"}";
+    } else {
+        jsize aLen = action ? env->GetArrayLength(action) : 0;
+        jsize jLen = json ? env->GetArrayLength(json) : 0;
+        jbyte* a = action ? env->GetByteArrayElements(action, nullptr) : nullptr;
+        jbyte* j = json ? env->GetByteArrayElements(json, nullptr) : nullptr;
+
+        module->call(std::string_view(a ? (const char*)a : "", aLen),
+                     std::string_view(j ? (const char*)j : "", jLen),
+                     t_resultPool);
+
+        if (a) env->ReleaseByteArrayElements(action, a, JNI_ABORT);
+        if (j) env->ReleaseByteArrayElements(json, j, JNI_ABORT);
+    }
+
+    jbyteArray result = env->NewByteArray((jsize)t_resultPool.size());
+    if (result) env->SetByteArrayRegion(result, 0, (jsize)t_resultPool.size(), (const jbyte*)t_resultPool.data());
+    return result;
+}
+
+// 4.3 批量调用: 一次 JNI 往返、一个实例跑完整批请求
+// actions 与 jsons 等长，返回与 actions 等长的结果数组；jsons 为 null 或长度不足时每项返回错误
+JNIEXPORT jobjectArray JNICALL
+Java_crow_wasmtime_wasmline_WasmEngine_nativeCallBatch(JNIEnv *env, jobject thiz, jlong handle,
+                                                       jobjectArray actions, jobjectArray jsons) {
+    auto* module = reinterpret_cast<WasmModule*>(handle);
+    jsize count = actions ? env->GetArrayLength(actions) : 0;
+
+    std::vector<std::string> results;
+    if (!module) {
+        results.assign(count, "{\"error\": \"Invalid Handle\"}");
+    } else if (!jsons || env->GetArrayLength(jsons) < count) {
+        results.assign(count, "{\"error\": \"Invalid Arguments\"}");
+    } else {
+        // 逐个拷贝并立即释放局部引用，批量再大也不会撑爆局部引用表
+        std::vector<std::string> actionStrs = toStrings(env, actions);
+        std::vector<std::string> jsonStrs = toStrings(env, jsons);
+        std::vector<std::pair<std::string_view, std::string_view>> items(count);
+        for (jsize i = 0; i < count; ++i) items[i] = {actionStrs[i], jsonStrs[i]};
+        module->callBatch(items, results);
+    }
+
+    jobjectArray out = env->NewObjectArray(count, g_stringClass, nullptr);
+    for (jsize i = 0; out && i < count; ++i) {
+        jstring item = env->NewStringUTF(results[i].c_str());
+        env->SetObjectArrayElement(out, i, item);
+        env->DeleteLocalRef(item);
+    }
+    return out;
+}
+
+// 4.4 异步调用: 提交到 Native 线程池后立即返回，完成时在工作线程上回调 callback.onNativeComplete(result)
+// 返回 false 表示线程池已满，callback 不会被调用
+JNIEXPORT jboolean JNICALL
+Java_crow_wasmtime_wasmline_WasmEngine_nativeCallAsync(JNIEnv *env, jobject thiz, jlong handle, jstring action, jstring json,
+                                                       jlong timeoutMs, jlong token, jobject callback) {
+    auto* module = reinterpret_cast<WasmModule*>(handle);
+    if (!module) return JNI_FALSE;
+
+    const char* a = env->GetStringUTFChars(action, nullptr);
+    const char* j = env->GetStringUTFChars(json, nullptr);
+    std::string actionStr(a ? a : "");
+    std::string jsonStr(j ? j : "");
+    if (a) env->ReleaseStringUTFChars(action, a);
+    if (j) env->ReleaseStringUTFChars(json, j);
+
+    jobject ref = env->NewGlobalRef(callback);
+    bool submitted = module->callAsync(std::move(actionStr), std::move(jsonStr), timeoutMs, toCancelToken(token),
+                                       [ref](std::string& result) {
+        withJniEnv([&](JNIEnv* jenv) {
+            jstring value = jenv->NewStringUTF(result.c_str());
+            if (g_callCallbackComplete) jenv->CallVoidMethod(ref, g_callCallbackComplete, value);
+            jenv->DeleteLocalRef(value);
+            jenv->DeleteGlobalRef(ref);
+        }, true);
+    });
+    if (!submitted) env->DeleteGlobalRef(ref);
+    return submitted ? JNI_TRUE : JNI_FALSE;
+}
+
 // 5. 释放资源
+// 不能在线程池工作线程上 (例如 callAsync 的回调里) 释放: 析构要等待池内任务，会自锁
 JNIEXPORT void JNICALL
 Java_crow_wasmtime_wasmline_WasmEngine_nativeRelease(JNIEnv *env, jobject thiz, jlong handle) {
     auto* module = reinterpret_cast<WasmModule*>(handle);
-    if (module) delete module;
+    if (!module) return;
+    if (WasmWorkerPool::isWorkerThread()) {
+        jclass error = env->FindClass("java/lang/IllegalStateException");
+        if (error) env->ThrowNew(error, "WasmEngine.close() must not be called on a wasm worker thread");
+        return;
+    }
+    delete module;
+}
+
+// 6. 打开常驻会话 (Store + Instance 只创建一次)
+// 返回: session 指针, 0 表示失败
+JNIEXPORT jlong JNICALL
+Java_crow_wasmtime_wasmline_WasmEngine_nativeOpenSession(JNIEnv *env, jobject thiz, jlong handle, jlongArray limits) {
+    auto* module = reinterpret_cast<WasmModule*>(handle);
+    if (!module) return 0;
+    if (!limits) return reinterpret_cast<jlong>(WasmSession::open(module));
+    return reinterpret_cast<jlong>(WasmSession::open(module, toLimits(env, limits)));
+}
+
+// 6.1 设置单次调用的 Store 资源上限
+JNIEXPORT void JNICALL
+Java_crow_wasmtime_wasmline_WasmEngine_nativeSetLimits(JNIEnv *env, jobject thiz, jlong handle, jlongArray limits) {
+    auto* module = reinterpret_cast<WasmModule*>(handle);
+    if (module) module->setCallLimits(toLimits(env, limits));
+}
+
+// 6.2 设置 Guest 日志策略 (级别 / 每秒行数上限 / Tag，tag 为 null 时保持不变)
+JNIEXPORT void JNICALL
+Java_crow_wasmtime_wasmline_WasmEngine_nativeSetLogPolicy(JNIEnv *env, jobject thiz, jlong handle, jint level,
+                                                          jint maxLinesPerSecond, jstring tag) {
+    auto* module = reinterpret_cast<WasmModule*>(handle);
+    if (!module) return;
+    WasmLogPolicy& policy = module->getLogPolicy();
+    policy.level.store(level);
+    policy.maxLinesPerSecond.store(maxLinesPerSecond < 0 ? 0 : (uint32_t) maxLinesPerSecond);
+    if (tag) {
+        const char* t = env->GetStringUTFChars(tag, nullptr);
+        if (t) {
+            module->setLogTag(t);
+            env->ReleaseStringUTFChars(tag, t);
+        }
+    }
+}
+
+// 6.3 设置 WASI 策略
+// env 为 [name0, value0, name1, value1, ...]；preopens 为 [host0, guest0, ...]，writable 与预打开目录一一对应
+// stdio: 0 = 日志队列, 1 = 继承宿主, 2 = 丢弃
+JNIEXPORT void JNICALL
+Java_crow_wasmtime_wasmline_WasmEngine_nativeSetWasiPolicy(JNIEnv *env, jobject thiz, jlong handle, jobjectArray envPairs,
+                                                           jobjectArray inheritEnv, jobjectArray args,
+                                                           jobjectArray preopens, jbooleanArray writable, jint stdio) {
+    auto* module = reinterpret_cast<WasmModule*>(handle);
+    if (!module) return;
+
+    WasmWasiPolicy policy;
+    std::vector<std::string> pairs = toStrings(env, envPairs);
+    for (size_t i = 0; i + 1 < pairs.size(); i += 2) policy.setEnv(pairs[i], pairs[i + 1]);
+    policy.allowEnv(toStrings(env, inheritEnv));
+    policy.setArgs(toStrings(env, args));
+
+    std::vector<std::string> dirs = toStrings(env, preopens);
+    std::vector<jboolean> flags(dirs.size() / 2, JNI_FALSE);
+    if (writable && !flags.empty() && env->GetArrayLength(writable) >= (jsize) flags.size()) {
+        env->GetBooleanArrayRegion(writable, 0, (jsize) flags.size(), flags.data());
+    }
+    for (size_t i = 0; i + 1 < dirs.size(); i += 2) policy.addPreopen(dirs[i], dirs[i + 1], !flags[i / 2]);
+
+    switch (stdio) {
+        case 1: policy.setStdio(WasmWasiPolicy::Stdio::Inherit); break;
+        case 2: policy.setStdio(WasmWasiPolicy::Stdio::Discard); break;
+        default: policy.setStdio(WasmWasiPolicy::Stdio::LogSink); break;
+    }
+    module->setWasiPolicy(policy);
+}
+
+// 6.4 读取执行统计，顺序与 WasmCounter 一致；reset 为 true 时读取后清零
+JNIEXPORT jlongArray JNICALL
+Java_crow_wasmtime_wasmline_WasmEngine_nativeStats(JNIEnv *env, jobject thiz, jlong handle, jboolean reset) {
+    auto* module = reinterpret_cast<WasmModule*>(handle);
+    WasmStatsSnapshot snapshot;
+    if (module) {
+        snapshot = module->stats();
+        if (reset) module->resetStats();
+    }
+    constexpr jsize count = (jsize) WasmCounter::Count;
+    jlong values[count];
+    for (jsize i = 0; i < count; ++i) values[i] = (jlong) snapshot.values[i];
+    jlongArray out = env->NewLongArray(count);
+    if (out) env->SetLongArrayRegion(out, 0, count, values);
+    return out;
+}
+
+// 6.5 按 action 的延迟直方图快照 (format: 0 = JSON, 1 = Prometheus)；module 为可选的模块标签
+static std::string toMetricsLabel(JNIEnv* env, jstring label) {
+    if (!label) return "";
+    const char* c = env->GetStringUTFChars(label, nullptr);
+    std::string out(c ? c : "");
+    if (c) env->ReleaseStringUTFChars(label, c);
+    return out;
+}
+
+static WasmMetrics::Format toMetricsFormat(jint format) {
+    return format == 1 ? WasmMetrics::Format::Prometheus : WasmMetrics::Format::Json;
+}
+
+JNIEXPORT jstring JNICALL
+Java_crow_wasmtime_wasmline_WasmEngine_nativeMetrics(JNIEnv *env, jobject thiz, jlong handle, jint format,
+                                                     jstring label, jboolean reset) {
+    auto* module = reinterpret_cast<WasmModule*>(handle);
+    if (!module) return env->NewStringUTF("");
+    std::string text = module->getMetrics().snapshot(toMetricsFormat(format), toMetricsLabel(env, label));
+    if (reset) module->getMetrics().reset();
+    return env->NewStringUTF(text.c_str());
+}
+
+JNIEXPORT jboolean JNICALL
+Java_crow_wasmtime_wasmline_WasmEngine_nativeWriteMetrics(JNIEnv *env, jobject thiz, jlong handle, jstring path,
+                                                          jint format, jstring label) {
+    auto* module = reinterpret_cast<WasmModule*>(handle);
+    if (!module || !path) return JNI_FALSE;
+    const char* p = env->GetStringUTFChars(path, nullptr);
+    std::string pathStr(p ? p : "");
+    if (p) env->ReleaseStringUTFChars(path, p);
+    bool ok = module->getMetrics().writeSnapshot(pathStr, toMetricsFormat(format), toMetricsLabel(env, label));
+    return ok ? JNI_TRUE : JNI_FALSE;
+}
+
+JNIEXPORT void JNICALL
+Java_crow_wasmtime_wasmline_WasmEngine_nativeResetMetrics(JNIEnv *env, jobject thiz, jlong handle) {
+    auto* module = reinterpret_cast<WasmModule*>(handle);
+    if (module) module->getMetrics().reset();
+}
+
+// 6.6 采样 Profiler: 开关 / 折叠栈导出 / 单个 action 的 Firefox Profiler JSON
+JNIEXPORT jboolean JNICALL
+Java_crow_wasmtime_wasmline_WasmEngine_nativeSetSampling(JNIEnv *env, jobject thiz, jlong handle, jboolean enabled,
+                                                         jlong intervalMs) {
+    auto* module = reinterpret_cast<WasmModule*>(handle);
+    if (!module) return JNI_FALSE;
+    return module->setSampling(enabled, intervalMs) ? JNI_TRUE : JNI_FALSE;
+}
+
+JNIEXPORT jstring JNICALL
+Java_crow_wasmtime_wasmline_WasmEngine_nativeSamplingFolded(JNIEnv *env, jobject thiz, jlong handle) {
+    auto* module = reinterpret_cast<WasmModule*>(handle);
+    return env->NewStringUTF(module ? module->samplingFolded().c_str() : "");
+}
+
+JNIEXPORT jstring JNICALL
+Java_crow_wasmtime_wasmline_WasmEngine_nativeSamplingProfile(JNIEnv *env, jobject thiz, jlong handle, jstring action) {
+    auto* module = reinterpret_cast<WasmModule*>(handle);
+    if (!module || !action) return env->NewStringUTF("{\"error\": \"Invalid Handle\"}");
+    const char* a = env->GetStringUTFChars(action, nullptr);
+    std::string profile = module->samplingProfile(a ? a : "");
+    if (a) env->ReleaseStringUTFChars(action, a);
+    return env->NewStringUTF(profile.c_str());
+}
+
+// 6.7 结果缓存: 配置容量 / TTL (maxBytes 为 0 关闭)，声明纯函数 action，读取命中统计
+JNIEXPORT void JNICALL
+Java_crow_wasmtime_wasmline_WasmEngine_nativeConfigureResultCache(JNIEnv *env, jobject thiz, jlong handle, jlong maxBytes,
+                                                                  jlong ttlMs, jobjectArray pureActions) {
+    auto* module = reinterpret_cast<WasmModule*>(handle);
+    if (!module) return;
+    // 可与调用并发: 先登记纯函数再开启缓存，开启后不会有调用看到只配置了一半的状态
+    WasmResultCache& cache = module->getResultCache();
+    for (const auto& action : toStrings(env, pureActions)) cache.declarePure(action);
+    cache.configure(maxBytes > 0 ? (size_t) maxBytes : 0, ttlMs);
+}
+
+JNIEXPORT jstring JNICALL
+Java_crow_wasmtime_wasmline_WasmEngine_nativeResultCacheStats(JNIEnv *env, jobject thiz, jlong handle) {
+    auto* module = reinterpret_cast<WasmModule*>(handle);
+    if (!module) return env->NewStringUTF("{\"error\": \"Invalid Handle\"}");
+    return env->NewStringUTF(module->getResultCache().statsJson().c_str());
+}
+
+// 7. 在会话上执行调用
+JNIEXPORT jstring JNICALL
+Java_crow_wasmtime_wasmline_WasmSession_nativeCall(JNIEnv *env, jobject thiz, jlong handle, jstring action, jstring json,
+                                                   jlong timeoutMs, jlong token) {
+    auto* session = reinterpret_cast<WasmSession*>(handle);
+    if (!session) return env->NewStringUTF("{\"error\": \"Invalid Session\"}");
+
+    const char* a = env->GetStringUTFChars(action, nullptr);
+    const char* j = env->GetStringUTFChars(json, nullptr);
+
+    std::string result = session->call(a ? a : "", j ? j : "", timeoutMs, toCancelToken(token));
+
+    if (a) env->ReleaseStringUTFChars(action, a);
+    if (j) env->ReleaseStringUTFChars(json, j);
+
+    return env->NewStringUTF(result.c_str());
+}
+
+// 8. 关闭会话
+JNIEXPORT void JNICALL
+Java_crow_wasmtime_wasmline_WasmSession_nativeClose(JNIEnv *env, jobject thiz, jlong handle) {
+    auto* session = reinterpret_cast<WasmSession*>(handle);
+    if (session) delete session;
+}
+
+// 9. 异步加载 (AOT 缓存优先，否则后台 JIT 编译)，立即返回
+// 完成后在工作线程上回调 task.onNativeComplete(handle)，handle 为 0 表示失败
+JNIEXPORT void JNICALL
+Java_crow_wasmtime_wasmline_WasmEngine_nativeLoadAsync(JNIEnv *env, jobject thiz, jstring sourceStr, jstring cacheStr, jstring profileStr, jobject taskObj) {
+    WasmConfig config = toConfig(env, profileStr);
+    const char* source = env->GetStringUTFChars(sourceStr, nullptr);
+    const char* cache = cacheStr ? env->GetStringUTFChars(cacheStr, nullptr) : nullptr;
+    auto task = WasmLoadTask::start(source, cache ? cache : "", config);
+    env->ReleaseStringUTFChars(sourceStr, source);
+    if (cache) env->ReleaseStringUTFChars(cacheStr, cache);
+
+    jobject ref = env->NewGlobalRef(taskObj);
+    task->onComplete([task, ref](bool success) {
+        WasmModule* module = success ? task->take() : nullptr;
+        withJniEnv([&](JNIEnv* jenv) {
+            if (g_loadTaskComplete) jenv->CallVoidMethod(ref, g_loadTaskComplete, reinterpret_cast<jlong>(module));
+            else delete module; // 无法交给 Java，避免泄漏
+            jenv->DeleteGlobalRef(ref);
+        });
+    });
+}
+
+// 10. 取消令牌
+JNIEXPORT jlong JNICALL
+Java_crow_wasmtime_wasmline_WasmCancelToken_nativeCreate(JNIEnv *env, jclass clazz) {
+    return reinterpret_cast<jlong>(new CancelTokenRef(std::make_shared<WasmCancelToken>()));
+}
+
+JNIEXPORT void JNICALL
+Java_crow_wasmtime_wasmline_WasmCancelToken_nativeCancel(JNIEnv *env, jclass clazz, jlong token) {
+    auto ref = toCancelToken(token);
+    if (ref) ref->cancel();
+}
+
+JNIEXPORT void JNICALL
+Java_crow_wasmtime_wasmline_WasmCancelToken_nativeRelease(JNIEnv *env, jclass clazz, jlong token) {
+    delete reinterpret_cast<CancelTokenRef*>(token);
 }
 
 } // extern C
\ No newline at end of file
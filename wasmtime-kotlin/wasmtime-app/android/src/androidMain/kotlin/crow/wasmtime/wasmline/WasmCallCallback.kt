@@ -0,0 +1,14 @@
+package crow.wasmtime.wasmline
+
+import androidx.annotation.Keep
+
+/**
+ * Native 异步调用的完成回调 (由 WasmEngine.callAsync 创建)
+ * 在 Native 工作线程上被调用，不要在这里做耗时操作。
+ */
+internal class WasmCallCallback(private val onComplete: (String) -> Unit) {
+
+    // Native 完成时回调
+    @Keep
+    private fun onNativeComplete(result: String) = onComplete(result)
+}
\ No newline at end of file
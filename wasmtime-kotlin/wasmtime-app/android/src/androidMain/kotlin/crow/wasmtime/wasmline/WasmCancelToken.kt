@@ -0,0 +1,39 @@
+package crow.wasmtime.wasmline
+
+import java.io.Closeable
+
+/**
+ * 调用取消令牌
+ *
+ * cancel() 后，使用该令牌的 Native 调用会在下一个 epoch 节拍 (约 5ms) 内被中断，
+ * 并返回 {"error": "Cancelled"}。一般不需要直接使用，WasmEngine.callSuspend 会在协程取消时自动触发。
+ * 仅对启用 epoch 中断的 Profile (如 ANDROID_INTERRUPTIBLE) 生效。
+ */
+class WasmCancelToken : Closeable {
+
+    internal val handle: Long = nativeCreate()
+
+    private var closed = false
+
+    @Synchronized
+    fun cancel() {
+        if (!closed) nativeCancel(handle)
+    }
+
+    @Synchronized
+    override fun close() {
+        if (!closed) {
+            closed = true
+            nativeRelease(handle)
+        }
+    }
+
+    companion object {
+        // 不依赖 WasmEngine 的类初始化顺序，单独创建令牌时也能找到 Native 方法
+        init { System.loadLibrary("wasmline") }
+
+        @JvmStatic private external fun nativeCreate(): Long
+        @JvmStatic private external fun nativeCancel(token: Long)
+        @JvmStatic private external fun nativeRelease(token: Long)
+    }
+}
\ No newline at end of file
@@ -1,11 +1,38 @@
 package crow.wasmtime.wasmline
 
 import android.content.Context
+import kotlinx.coroutines.CancellationException
+import kotlinx.coroutines.Dispatchers
+import kotlinx.coroutines.async
+import kotlinx.coroutines.coroutineScope
+import kotlinx.coroutines.suspendCancellableCoroutine
 import java.io.File
 import java.io.FileOutputStream
 import java.io.Closeable
+import java.nio.ByteBuffer
+import java.util.Collections
+import java.util.concurrent.ConcurrentHashMap
+import java.util.concurrent.locks.ReentrantReadWriteLock
+import kotlin.concurrent.read
+import kotlin.concurrent.write
+import kotlin.coroutines.resume
 
-class WasmEngine private constructor(private val handle: Long) : Closeable {
+/**
+ * 已加载的 Wasm 插件
+ *
+ * 线程安全：同一个 WasmEngine 可以被多个线程 / 协程并发调用，
+ * Native 层每次调用使用独立的 Store，Engine / Module / Linker 只读共享，调用方无需再加互斥锁。
+ * close() 会等待在途调用结束后再释放。
+ * 各项设置 (setLimits / setGuestLog / setWasiPolicy) 在 Native 层以不可变快照整体替换，
+ * 只对之后新建的 Store 生效，不影响在途调用与 Native 线程池中排队的 callAsync。
+ */
+class WasmEngine internal constructor(private var handle: Long) : Closeable {
+
+    // 调用持读锁 (可并发)，close 持写锁 (等待在途调用结束)
+    private val lock = ReentrantReadWriteLock()
+
+    // 尚未关闭的会话: Native 会话引用本模块，close 时必须先于模块释放
+    private val sessions: MutableSet<WasmSession> = Collections.newSetFromMap(ConcurrentHashMap())
 
     companion object {
         init { System.loadLibrary("wasmline") }
@@ -18,14 +45,15 @@ class WasmEngine private constructor(private val handle: Long) : Closeable {
          *
          * @param sourceFile 源码文件 (.wasm)
          * @param cacheFile  缓存文件 (.cwasm)，如果为 null，则不使用磁盘缓存
+         * @param profile    引擎配置 Profile，不同 Profile 的缓存互不兼容，会被自动判定为过期
          */
-        fun load(sourceFile: File, cacheFile: File? = null): WasmEngine {
-            // 1. 尝试 AOT (缓存命中)
+        fun load(sourceFile: File, cacheFile: File? = null, profile: WasmProfile = WasmProfile.ANDROID_SAFE): WasmEngine {
+            // 1. 尝试 AOT (缓存命中，C++ 默认 mmap 映射 .cwasm，失败自动回退到整读)
             if (cacheFile != null && cacheFile.exists()) {
-                val handle = nativeInitPath(cacheFile.absolutePath)
+                val handle = nativeInitPath(cacheFile.absolutePath, profile.id)
                 if (handle != 0L) return WasmEngine(handle)
-                // 缓存损坏，删除
-                cacheFile.delete()
+                // 缓存损坏或过期 (引擎配置 / Wasmtime 版本变化)，删除
+                deleteCache(cacheFile)
             }
 
             // 2. 尝试 JIT (从源码路径编译)
@@ -34,19 +62,37 @@ class WasmEngine private constructor(private val handle: Long) : Closeable {
                 throw RuntimeException("Source file not found: ${sourceFile.absolutePath}")
             }
 
-            val handle = nativeInitSourcePath(sourceFile.absolutePath)
+            val handle = nativeInitSourcePath(sourceFile.absolutePath, profile.id)
             if (handle == 0L) {
                 throw RuntimeException("Failed to compile wasm from file: ${sourceFile.absolutePath}")
             }
 
-            // 3. 编译成功后，保存缓存
-            if (cacheFile != null) {
-                nativeSaveCache(handle, cacheFile.absolutePath)
+            // 3. 编译成功后，保存缓存 (原子写入，失败不会留下半截文件，只是下次重新编译)
+            if (cacheFile != null && !nativeSaveCache(handle, cacheFile.absolutePath)) {
+                "Failed to save wasm cache: ${cacheFile.absolutePath}".info()
             }
 
             return WasmEngine(handle)
         }
 
+        /**
+         * 异步加载 (非阻塞)
+         * 立即返回任务句柄，缓存命中走 AOT，否则在 Native 工作线程上 JIT 编译；
+         * 编译完成后先通知调用方，.cwasm 缓存随后在后台写入，不占用关键路径。
+         *
+         * @param sourceFile 源码文件 (.wasm)
+         * @param cacheFile  缓存文件 (.cwasm)，如果为 null，则不使用磁盘缓存
+         * @param profile    引擎配置 Profile
+         */
+        fun loadAsync(sourceFile: File, cacheFile: File? = null, profile: WasmProfile = WasmProfile.ANDROID_SAFE): WasmLoadTask {
+            if (!sourceFile.exists() && cacheFile?.exists() != true) {
+                throw RuntimeException("Source file not found: ${sourceFile.absolutePath}")
+            }
+            val task = WasmLoadTask()
+            nativeLoadAsync(sourceFile.absolutePath, cacheFile?.absolutePath, profile.id, task)
+            return task
+        }
+
         /**
          * 从 Assets 加载
          *
@@ -54,7 +100,12 @@ class WasmEngine private constructor(private val handle: Long) : Closeable {
          * 1. 如果文件很大，流式拷贝到缓存目录的临时文件，然后走 C++ 文件加载 (防 OOM)。
          * 2. 如果文件很小，为了速度可以直接走内存 (可选，但为了统一逻辑，建议都走临时文件更稳健)。
          */
-        fun loadFromAssets(context: Context, assetName: String, cacheName: String? = null): WasmEngine {
+        fun loadFromAssets(
+            context: Context,
+            assetName: String,
+            cacheName: String? = null,
+            profile: WasmProfile = WasmProfile.ANDROID_SAFE
+        ): WasmEngine {
             // 确定缓存路径
             // 如果用户没传 cacheName，我们默认生成一个 .cwasm
             val finalCacheFile = if (cacheName != null) {
@@ -63,11 +114,11 @@ class WasmEngine private constructor(private val handle: Long) : Closeable {
                 File(context.cacheDir, "$assetName.cwasm")
             }
 
-            // 1. 检查缓存是否可用 (AOT)
+            // 1. 检查缓存是否可用 (AOT，mmap 映射)
             if (finalCacheFile.exists()) {
-                val handle = nativeInitPath(finalCacheFile.absolutePath)
+                val handle = nativeInitPath(finalCacheFile.absolutePath, profile.id)
                 if (handle != 0L) return WasmEngine(handle)
-                finalCacheFile.delete()
+                deleteCache(finalCacheFile)
             }
 
             // 2. 缓存未命中：需要从 Assets 读取源码
@@ -85,7 +136,7 @@ class WasmEngine private constructor(private val handle: Long) : Closeable {
 
                 // 3. 调用通用的文件加载逻辑
                 // 此时 tempSourceFile 是物理文件，C++ 读取无压力
-                return load(tempSourceFile, finalCacheFile)
+                return load(tempSourceFile, finalCacheFile, profile)
 
             } finally {
                 // 4. 清理临时源码文件 (编译完就不需要源码了，因为已经有 .cwasm 缓存了，或者内存里已经有 module 了)
@@ -95,15 +146,255 @@ class WasmEngine private constructor(private val handle: Long) : Closeable {
             }
         }
 
-        @JvmStatic private external fun nativeInitPath(path: String): Long       // AOT (.cwasm)
-        @JvmStatic private external fun nativeInitSourcePath(path: String): Long // JIT (.wasm from file)
-        @JvmStatic private external fun nativeInitBytes(bytes: ByteArray): Long  // JIT (.wasm from memory)
+        // .cwasm 与其旁路缓存头 (.cwasm.meta) 一起删除
+        private fun deleteCache(cacheFile: File) {
+            cacheFile.delete()
+            File(cacheFile.path + ".meta").delete()
+        }
+
+        @JvmStatic private external fun nativeInitPath(path: String, profile: String): Long       // AOT (.cwasm, mmap)
+        @JvmStatic private external fun nativeInitSourcePath(path: String, profile: String): Long // JIT (.wasm from file)
+        @JvmStatic private external fun nativeInitBytes(bytes: ByteArray, profile: String): Long  // JIT (.wasm from memory)
         @JvmStatic private external fun nativeSaveCache(handle: Long, path: String): Boolean
+        @JvmStatic private external fun nativeLoadAsync(sourcePath: String, cachePath: String?, profile: String, task: WasmLoadTask)
+    }
+
+    /**
+     * 同步调用
+     * @param timeoutMs 超时时间，< 0 表示不限时；超时返回 {"error": "Timeout"}
+     *                  需要以启用 epoch 中断的 Profile (ANDROID_INTERRUPTIBLE / LINUX_SERVER_FAST) 加载，否则被忽略
+     */
+    fun call(action: String, json: String, timeoutMs: Long = -1L): String =
+        lock.read { nativeCall(checkHandle(), action, json, timeoutMs, 0L) }
+
+    /**
+     * 异步调用 (Native 线程池)
+     * 提交后立即挂起，不占用任何 JVM 线程；调用在 Native 工作线程上执行 (并发度等于 CPU 核数)，
+     * 完成后在工作线程上恢复协程。协程取消会中断正在执行的 Native 调用 (需启用 epoch 中断的 Profile)。
+     * 线程池过载时返回 {"error": "Queue Full"}。
+     */
+    suspend fun callAsync(action: String, json: String, timeoutMs: Long = -1L): String =
+        suspendCancellableCoroutine { cont ->
+            val token = WasmCancelToken()
+            val callback = WasmCallCallback { result ->
+                token.close()
+                cont.resume(result)
+            }
+            // 令牌关闭后 cancel 为空操作，完成与取消的先后顺序无需额外同步
+            cont.invokeOnCancellation { token.cancel() }
+            val submitted = lock.read { nativeCallAsync(checkHandle(), action, json, timeoutMs, token.handle, callback) }
+            if (!submitted) {
+                token.close()
+                cont.resume("{\"error\": \"Queue Full\"}")
+            }
+        }
+
+    /**
+     * 批量调用
+     * 整批只有一次 JNI 往返，共用一个 Store 和实例 (_initialize 只执行一次)，结果与请求一一对应。
+     * 适合连续发出大量小请求的场景。
+     */
+    fun callBatch(requests: List<Pair<String, String>>): List<String> {
+        if (requests.isEmpty()) return emptyList()
+        val actions = Array(requests.size) { requests[it].first }
+        val jsons = Array(requests.size) { requests[it].second }
+        return lock.read { nativeCallBatch(checkHandle(), actions, jsons) }.asList()
+    }
+
+    /**
+     * 挂起调用 (在 IO 线程上执行)
+     * 协程被取消时会中断正在执行的 Native 调用，而不是等它跑完 (需启用 epoch 中断的 Profile，否则等待调用结束)。
+     */
+    suspend fun callSuspend(action: String, json: String, timeoutMs: Long = -1L): String =
+        WasmCancelToken().use { token ->
+            coroutineScope {
+                val result = async(Dispatchers.IO) {
+                    lock.read { nativeCall(checkHandle(), action, json, timeoutMs, token.handle) }
+                }
+                try {
+                    result.await()
+                } catch (e: CancellationException) {
+                    // coroutineScope 会等待 Native 调用在下一个 epoch 节拍退出后再返回
+                    token.cancel()
+                    throw e
+                }
+            }
+        }
+
+    /**
+     * DirectByteBuffer 调用 (UTF-8)
+     * action / json 必须是 DirectByteBuffer，读取 position..limit 区间，Native 直接读其内存，输入不做拷贝。
+     *
+     * 输出不是零拷贝: 结果先在 Native 暂存区累积，调用结束后拷贝一次，
+     * 写入 out 的 position..limit 区间 (out 为可复用的 DirectByteBuffer)，返回 out 本身，
+     * position 不变、limit 指向结果末尾；out 为 null 或空间不足时返回一块新分配的 DirectByteBuffer。
+     * 返回的缓冲区归调用方所有，跨线程 / 协程挂起点读取都安全。
+     */
+    fun callBuffer(action: ByteBuffer, json: ByteBuffer, out: ByteBuffer? = null): ByteBuffer {
+        require(action.isDirect && json.isDirect) { "callBuffer requires direct ByteBuffers" }
+        require(out == null || (out.isDirect && !out.isReadOnly)) { "callBuffer output must be a writable direct ByteBuffer" }
+        return lock.read {
+            nativeCallBuffer(
+                checkHandle(),
+                action, action.position(), action.remaining(),
+                json, json.position(), json.remaining(),
+                out, out?.position() ?: 0, out?.remaining() ?: 0
+            )
+        }
     }
 
-    fun call(action: String, json: String): String = nativeCall(handle, action, json)
-    override fun close() = nativeRelease(handle)
+    /**
+     * 字节数组调用 (UTF-8)
+     * 绕过 jstring 的 Modified UTF-8 转换，非 BMP 字符 (如 emoji) 可原样往返。
+     */
+    fun callBytes(action: ByteArray, json: ByteArray): ByteArray = lock.read { nativeCallBytes(checkHandle(), action, json) }
+
+    /**
+     * 设置单次调用的资源上限 (每次 call 新建的 Store 生效)
+     * 触顶时 Guest 的 memory.grow 失败，调用返回 Guest 自身的错误 (通常是 Run Trap 或路由返回的错误 JSON)，
+     * 不会单独标注为内存超限；在途调用仍使用旧的上限。
+     */
+    fun setLimits(limits: WasmLimits) = lock.read { nativeSetLimits(checkHandle(), limits.toArray()) }
+
+    /**
+     * 设置 Guest 日志 (WASI stdout / stderr) 策略
+     * 日志异步写入 logcat，低于 level 的行直接丢弃；超出每秒行数上限的部分会被丢弃并补一条丢弃计数。
+     *
+     * @param maxLinesPerSecond 每秒最多输出的行数，0 表示不限流
+     * @param tag logcat Tag (最长 31 字节)，为 null 时保持不变
+     */
+    fun setGuestLog(level: WasmLogLevel, maxLinesPerSecond: Int = 200, tag: String? = null) =
+        lock.read { nativeSetLogPolicy(checkHandle(), level.priority, maxLinesPerSecond, tag) }
+
+    /**
+     * 设置 WASI 策略 (环境变量、argv、预打开目录、标准输出去向)
+     * 之后每次调用按该策略建立 WASI 上下文；在途调用仍使用旧策略。
+     * 上下文建立失败 (如预打开目录不存在) 时调用不会进入 Wasm，直接返回 {"error": "WASI Setup Failed", ...}。
+     */
+    fun setWasiPolicy(policy: WasmWasiPolicy) = lock.read {
+        nativeSetWasiPolicy(
+            checkHandle(), policy.envPairs(), policy.inheritEnv.toTypedArray(), policy.args.toTypedArray(),
+            policy.preopenPaths(), policy.preopenWritable(), policy.stdio.id
+        )
+    }
+
+    /**
+     * 读取执行统计 (模块加载以来的累计值)
+     * @param reset 为 true 时读取后清零，便于按时间窗口采样
+     */
+    fun stats(reset: Boolean = false): WasmStats = lock.read { WasmStats.fromArray(nativeStats(checkHandle(), reset)) }
+
+    /**
+     * 按 action 统计的 run_entry 延迟 (p50 / p90 / p99 / p999) 与错误数快照
+     *
+     * 延迟不含 Store 创建、实例化与 _initialize (见 [stats])
+     * @param label 可选的模块标签 (Prometheus 的 module 标签 / JSON 的 module 字段)，便于多插件汇总
+     * @param reset 为 true 时导出后清零
+     */
+    fun metrics(format: WasmMetricsFormat = WasmMetricsFormat.JSON, label: String? = null, reset: Boolean = false): String =
+        lock.read { nativeMetrics(checkHandle(), format.id, label, reset) }
+
+    /** 把指标快照原子写入文件 (如供 node_exporter textfile collector 采集) */
+    fun writeMetrics(file: File, format: WasmMetricsFormat = WasmMetricsFormat.PROMETHEUS, label: String? = null): Boolean =
+        lock.read { nativeWriteMetrics(checkHandle(), file.absolutePath, format.id, label) }
+
+    fun resetMetrics() = lock.read { nativeResetMetrics(checkHandle()) }
+
+    /**
+     * 开关进程内采样 Profiler (无需 perf，也无需重新编译)
+     * 开启后调用期间每隔 intervalMs (不低于 5ms) 采集一次 Guest 调用栈，按 action 聚合。
+     * @return Engine 未启用 epoch 中断时返回 false
+     */
+    fun setSampling(enabled: Boolean, intervalMs: Long = 10L): Boolean =
+        lock.read { nativeSetSampling(checkHandle(), enabled, intervalMs) }
+
+    /**
+     * 折叠栈文本 ("action;阶段 次数")，可直接交给 flamegraph.pl / inferno-flamegraph
+     *
+     * 只有 action 与阶段两层，不含 Guest 函数帧 (C API 无法在 epoch 回调里抓取调用栈)；函数级热点见 [samplingProfile]。
+     */
+    fun samplingFolded(): String = lock.read { nativeSamplingFolded(checkHandle()) }
+
+    /** 某个 action 的 Firefox Profiler JSON (带 Guest 函数名)，在 profiler.firefox.com 打开；导出后该 action 重新采集 */
+    fun samplingProfile(action: String): String = lock.read { nativeSamplingProfile(checkHandle(), action) }
+
+    /**
+     * 开启纯函数 action 的结果缓存 (LRU)
+     * 命中时 call 直接返回缓存结果，不创建 Store、不进入 Wasm；错误结果不缓存。
+     * 除 pureActions 外，插件也可以在初始化时用 WasmRouter.registerPure 自行声明
+     * (预初始化快照不执行初始化，需导出 __wasmline_declare_pure，否则只认这里传入的 pureActions)。
+     * 与其他设置一样可与调用并发：Native 层先登记 pureActions 再整体替换容量 / TTL，在途调用不受影响。
+     *
+     * @param maxBytes 缓存容量 (action + json + 结果的字节数)，0 表示关闭；重新配置会清空已有条目
+     * @param ttlMs 条目有效期，0 表示不过期
+     */
+    fun setResultCache(maxBytes: Long, ttlMs: Long = 0L, pureActions: Collection<String> = emptyList()) =
+        lock.read { nativeConfigureResultCache(checkHandle(), maxBytes, ttlMs, pureActions.toTypedArray()) }
+
+    /** 结果缓存统计 JSON: {"enabled", "hits", "misses", "evictions", "entries", "bytes"} */
+    fun resultCacheStats(): String = lock.read { nativeResultCacheStats(checkHandle()) }
+
+    /**
+     * 打开常驻会话
+     * 会话持有一个已初始化的实例，_initialize 只执行一次，适合高频调用。
+     * 未关闭的会话会在 WasmEngine.close() 时随之关闭 (等待其在途调用结束)。
+     *
+     * @param limits 会话级资源上限 (会话内存跨调用累积)，为 null 时沿用 setLimits 设置的单次调用上限
+     */
+    fun openSession(limits: WasmLimits? = null): WasmSession = lock.read {
+        val session = nativeOpenSession(checkHandle(), limits?.toArray())
+        if (session == 0L) throw RuntimeException("Failed to open wasm session")
+        // 在读锁内登记，close 不会错过正在打开的会话
+        WasmSession(session, this).also { sessions.add(it) }
+    }
+
+    internal fun onSessionClosed(session: WasmSession) {
+        sessions.remove(session)
+    }
+
+    /**
+     * 释放模块
+     * 会阻塞当前线程: 先等待持锁的同步调用结束并关闭尚未关闭的会话，再在 Native 层等待线程池中本模块的 callAsync (含仍在排队的) 全部执行完毕。
+     * 异步任务较多时可能耗时较长，不要在主线程上调用。
+     * 不能在 Native 工作线程上调用 (例如以 Dispatchers.Unconfined 从 callAsync 直接恢复的协程)，否则抛出 IllegalStateException。
+     */
+    override fun close() = lock.write {
+        if (handle != 0L) {
+            sessions.forEach { it.release() }
+            sessions.clear()
+            nativeRelease(handle)
+            handle = 0L
+        }
+    }
+
+    private fun checkHandle(): Long {
+        check(handle != 0L) { "WasmEngine is closed" }
+        return handle
+    }
 
-    private external fun nativeCall(h: Long, a: String, j: String): String
+    private external fun nativeCall(h: Long, a: String, j: String, timeoutMs: Long, token: Long): String
+    private external fun nativeCallBuffer(
+        h: Long, a: ByteBuffer, aOff: Int, aLen: Int, j: ByteBuffer, jOff: Int, jLen: Int,
+        out: ByteBuffer?, outOff: Int, outCap: Int
+    ): ByteBuffer
+    private external fun nativeCallAsync(h: Long, a: String, j: String, timeoutMs: Long, token: Long, callback: WasmCallCallback): Boolean
+    private external fun nativeCallBatch(h: Long, actions: Array<String>, jsons: Array<String>): Array<String>
+    private external fun nativeCallBytes(h: Long, a: ByteArray, j: ByteArray): ByteArray
+    private external fun nativeOpenSession(h: Long, limits: LongArray?): Long
+    private external fun nativeSetLimits(h: Long, limits: LongArray)
+    private external fun nativeSetLogPolicy(h: Long, level: Int, maxLinesPerSecond: Int, tag: String?)
+    private external fun nativeStats(h: Long, reset: Boolean): LongArray
+    private external fun nativeMetrics(h: Long, format: Int, label: String?, reset: Boolean): String
+    private external fun nativeWriteMetrics(h: Long, path: String, format: Int, label: String?): Boolean
+    private external fun nativeResetMetrics(h: Long)
+    private external fun nativeSetSampling(h: Long, enabled: Boolean, intervalMs: Long): Boolean
+    private external fun nativeSamplingFolded(h: Long): String
+    private external fun nativeSamplingProfile(h: Long, action: String): String
+    private external fun nativeConfigureResultCache(h: Long, maxBytes: Long, ttlMs: Long, pureActions: Array<String>)
+    private external fun nativeResultCacheStats(h: Long): String
+    private external fun nativeSetWasiPolicy(
+        h: Long, env: Array<String>, inheritEnv: Array<String>, args: Array<String>,
+        preopens: Array<String>, writable: BooleanArray, stdio: Int
+    )
     private external fun nativeRelease(h: Long)
 }
\ No newline at end of file
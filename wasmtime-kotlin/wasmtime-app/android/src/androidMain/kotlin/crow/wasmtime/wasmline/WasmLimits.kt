@@ -0,0 +1,22 @@
+package crow.wasmtime.wasmline
+
+/**
+ * 单个 Store 的资源上限，-1 表示不限制
+ *
+ * Kotlin/Wasm 的对象分配在 GC 堆上，Wasmtime C API 暂不支持限制 GC 堆，
+ * 这里约束的是线性内存 (withScopedMemoryAllocator 等)、表与实例数量。
+ */
+data class WasmLimits(
+    val memoryBytes: Long = -1L,
+    val tableElements: Long = -1L,
+    val instances: Long = -1L,
+    val tables: Long = -1L,
+    val memories: Long = -1L,
+) {
+    internal fun toArray() = longArrayOf(memoryBytes, tableElements, instances, tables, memories)
+
+    companion object {
+        // Wasm 线性内存页大小
+        const val PAGE_SIZE = 64L * 1024
+    }
+}
\ No newline at end of file
@@ -0,0 +1,73 @@
+package crow.wasmtime.wasmline
+
+import androidx.annotation.Keep
+import kotlinx.coroutines.suspendCancellableCoroutine
+import java.util.concurrent.CountDownLatch
+import java.util.concurrent.TimeUnit
+import java.util.concurrent.TimeoutException
+import kotlin.coroutines.resume
+import kotlin.coroutines.resumeWithException
+
+/**
+ * 异步加载任务 (由 WasmEngine.loadAsync 创建)
+ *
+ * 编译在 Native 工作线程上进行，调用方可以：
+ * 1. await() 阻塞等待；
+ * 2. onComplete() 注册回调 (在 Native 工作线程上执行)；
+ * 3. 在协程中 awaitEngine() 挂起等待。
+ */
+class WasmLoadTask internal constructor() {
+
+    private val latch = CountDownLatch(1)
+    private val listeners = mutableListOf<(WasmEngine?) -> Unit>()
+
+    @Volatile
+    private var engine: WasmEngine? = null
+
+    val isDone: Boolean get() = latch.count == 0L
+
+    /**
+     * 阻塞等待加载完成
+     * @param timeoutMs 超时时间，< 0 表示一直等待
+     */
+    fun await(timeoutMs: Long = -1): WasmEngine {
+        if (timeoutMs < 0) {
+            latch.await()
+        } else if (!latch.await(timeoutMs, TimeUnit.MILLISECONDS)) {
+            throw TimeoutException("Wasm module is still compiling")
+        }
+        return engine ?: throw RuntimeException("Failed to load wasm module")
+    }
+
+    /** 注册完成回调，加载失败时参数为 null；若已完成则立即在当前线程回调 */
+    fun onComplete(listener: (WasmEngine?) -> Unit) {
+        synchronized(listeners) {
+            if (!isDone) {
+                listeners += listener
+                return
+            }
+        }
+        listener(engine)
+    }
+
+    suspend fun awaitEngine(): WasmEngine = suspendCancellableCoroutine { cont ->
+        onComplete { result ->
+            if (result != null) cont.resume(result)
+            else cont.resumeWithException(RuntimeException("Failed to load wasm module"))
+        }
+    }
+
+    // Native 工作线程回调，handle 为 0 表示加载失败
+    @Keep
+    @Suppress("unused")
+    private fun onNativeComplete(handle: Long) {
+        val pending: List<(WasmEngine?) -> Unit>
+        synchronized(listeners) {
+            engine = if (handle != 0L) WasmEngine(handle) else null
+            latch.countDown()
+            pending = listeners.toList()
+            listeners.clear()
+        }
+        pending.forEach { it(engine) }
+    }
+}
\ No newline at end of file
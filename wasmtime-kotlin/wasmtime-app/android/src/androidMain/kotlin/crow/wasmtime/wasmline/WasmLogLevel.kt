@@ -0,0 +1,15 @@
+package crow.wasmtime.wasmline
+
+/**
+ * Guest 日志级别 (priority 与 android.util.Log 的优先级一致)
+ *
+ * WASI stdout 记为 INFO，stderr 记为 WARN；OFF 丢弃全部 Guest 输出。
+ */
+enum class WasmLogLevel(val priority: Int) {
+    VERBOSE(2),
+    DEBUG(3),
+    INFO(4),
+    WARN(5),
+    ERROR(6),
+    OFF(7)
+}
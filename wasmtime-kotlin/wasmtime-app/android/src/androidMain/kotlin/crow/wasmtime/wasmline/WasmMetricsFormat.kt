@@ -0,0 +1,8 @@
+package crow.wasmtime.wasmline
+
+/** 指标快照的导出格式 (对应 Native 层 WasmMetrics::Format) */
+enum class WasmMetricsFormat(internal val id: Int) {
+    JSON(0),
+    // Prometheus text exposition format
+    PROMETHEUS(1)
+}
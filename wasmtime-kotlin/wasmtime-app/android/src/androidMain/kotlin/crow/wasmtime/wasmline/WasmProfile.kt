@@ -0,0 +1,17 @@
+package crow.wasmtime.wasmline
+
+/**
+ * 引擎配置 Profile (与 Native 层 WasmConfig 的命名 Profile 一一对应)
+ *
+ * 同一 Profile 的模块共享一个 Engine；不同 Profile 的模块可以同时加载、互不影响。
+ */
+enum class WasmProfile(val id: String) {
+    // 兼容性优先: SIMD 关闭、显式边界检查、无保护页、512KB 栈；不支持超时与取消
+    ANDROID_SAFE("android-safe"),
+    // ANDROID_SAFE + epoch 中断: 支持超时、协程取消与采样 Profiler，每个函数入口 / 循环回边多一次检查
+    ANDROID_INTERRUPTIBLE("android-interruptible"),
+    // 桌面 / 服务器: SIMD、信号 Trap、默认内存预留
+    LINUX_SERVER_FAST("linux-server-fast"),
+    // 关闭 Cranelift 优化，首次编译最快
+    FAST_STARTUP("fast-startup")
+}
\ No newline at end of file
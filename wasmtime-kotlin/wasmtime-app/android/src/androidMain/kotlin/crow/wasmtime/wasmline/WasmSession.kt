@@ -0,0 +1,51 @@
+package crow.wasmtime.wasmline
+
+import java.io.Closeable
+import java.util.concurrent.locks.ReentrantReadWriteLock
+import kotlin.concurrent.read
+import kotlin.concurrent.write
+
+/**
+ * 常驻会话 (由 WasmEngine.openSession 创建)
+ *
+ * 与 WasmEngine.call 每次新建 Store 不同，会话复用同一个 Store 和 Instance，
+ * 每次调用只重置输入输出缓冲区，省去 Kotlin 运行时启动和路由注册的开销。
+ * 同一会话上的调用在 Native 层串行执行。
+ * close() 可重复调用；WasmEngine.close() 会先关闭它打开的所有会话，之后再调用会话抛出 IllegalStateException。
+ */
+class WasmSession internal constructor(private var handle: Long, private val owner: WasmEngine) : Closeable {
+
+    // 调用持读锁，close 持写锁 (等待在途调用结束)
+    private val lock = ReentrantReadWriteLock()
+
+    /**
+     * @param timeoutMs 超时时间，< 0 表示不限时；超时 / 取消后会话会在下次调用时自动重建实例
+     */
+    fun call(action: String, json: String, timeoutMs: Long = -1L): String =
+        lock.read { nativeCall(checkHandle(), action, json, timeoutMs, 0L) }
+
+    /** 同 call，但使用调用方提供的取消令牌 */
+    fun call(action: String, json: String, timeoutMs: Long, token: WasmCancelToken): String =
+        lock.read { nativeCall(checkHandle(), action, json, timeoutMs, token.handle) }
+
+    override fun close() {
+        release()
+        owner.onSessionClosed(this)
+    }
+
+    // 释放 Native 会话 (幂等)，WasmEngine.close() 也经由这里关闭
+    internal fun release() = lock.write {
+        if (handle != 0L) {
+            nativeClose(handle)
+            handle = 0L
+        }
+    }
+
+    private fun checkHandle(): Long {
+        check(handle != 0L) { "WasmSession is closed" }
+        return handle
+    }
+
+    private external fun nativeCall(h: Long, a: String, j: String, timeoutMs: Long, token: Long): String
+    private external fun nativeClose(h: Long)
+}
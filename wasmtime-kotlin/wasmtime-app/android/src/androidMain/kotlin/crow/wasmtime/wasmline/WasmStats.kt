@@ -0,0 +1,34 @@
+package crow.wasmtime.wasmline
+
+/**
+ * 模块执行统计 (对应 Native 层 WasmStats，耗时单位为纳秒)
+ *
+ * 用于区分一次慢调用耗在 Store 创建 / 实例化 / _initialize 等准备阶段，还是 run_entry 里的 Guest 代码。
+ */
+data class WasmStats(
+    val storeCreateNs: Long,
+    val storeCreateCount: Long,
+    val instantiateNs: Long,
+    val instantiateCount: Long,
+    val initializeNs: Long,
+    val initializeCount: Long,
+    val runNs: Long,
+    val runCount: Long,
+    val hostCalls: Long,
+    val bytesIn: Long,
+    val bytesOut: Long,
+) {
+    // run_entry 平均耗时 (ns)
+    val runAvgNs: Long get() = if (runCount == 0L) 0L else runNs / runCount
+
+    internal companion object {
+        // 顺序与 Native 层 WasmCounter 一致
+        fun fromArray(v: LongArray) = WasmStats(
+            storeCreateNs = v[0], storeCreateCount = v[1],
+            instantiateNs = v[2], instantiateCount = v[3],
+            initializeNs = v[4], initializeCount = v[5],
+            runNs = v[6], runCount = v[7],
+            hostCalls = v[8], bytesIn = v[9], bytesOut = v[10],
+        )
+    }
+}
@@ -0,0 +1,30 @@
+package crow.wasmtime.wasmline
+
+/**
+ * 模块级 WASI 策略 (对应 Native 层 WasmWasiPolicy)
+ *
+ * 默认不向 Guest 暴露任何宿主环境变量；inheritEnv 是白名单，在 setWasiPolicy 时从进程环境中读取一次。
+ * 模块未导入 WASI 时策略不生效，每次调用完全跳过 WASI 初始化。
+ */
+data class WasmWasiPolicy(
+    val env: Map<String, String> = emptyMap(),
+    val inheritEnv: List<String> = emptyList(),
+    val args: List<String> = emptyList(),
+    val preopens: List<Preopen> = emptyList(),
+    val stdio: Stdio = Stdio.LOG,
+) {
+    data class Preopen(val hostPath: String, val guestPath: String, val writable: Boolean = false)
+
+    enum class Stdio(internal val id: Int) {
+        // 异步写入 logcat，受 setGuestLog 的级别与限流约束
+        LOG(0),
+        // 直接写宿主进程的 stdout / stderr
+        INHERIT(1),
+        // 丢弃
+        DISCARD(2)
+    }
+
+    internal fun envPairs(): Array<String> = env.flatMap { listOf(it.key, it.value) }.toTypedArray()
+    internal fun preopenPaths(): Array<String> = preopens.flatMap { listOf(it.hostPath, it.guestPath) }.toTypedArray()
+    internal fun preopenWritable(): BooleanArray = BooleanArray(preopens.size) { preopens[it].writable }
+}
@@ -1,8 +1,11 @@
-@file:OptIn(ExperimentalWasmInterop::class)
+@file:OptIn(ExperimentalWasmInterop::class, UnsafeWasmMemoryApi::class)
 @file:Suppress("FunctionName")
 
 package crow.wasmtime.wasmline
 
+import kotlin.wasm.unsafe.UnsafeWasmMemoryApi
+import kotlin.wasm.unsafe.withScopedMemoryAllocator
+
 // --- 1. 底层 Import (全部 private/internal，对外隐藏) ---
 @WasmImport("env", "host_get_action_size")
 external fun host_get_action_size(): Int
@@ -10,11 +13,16 @@ external fun host_get_action_size(): Int
 @WasmImport("env", "host_get_json_size")
 external fun host_get_json_size(): Int
 
-@WasmImport("env", "host_read_input_byte")
-external fun host_read_input_byte(type: Int, index: Int): Int
+// 批量 ABI: Host 直接 memcpy 进出线性内存 (旧的逐字节 host_read_input_byte / host_write_result_byte 仍由 Host 保留)
+@WasmImport("env", "host_read_input")
+external fun host_read_input(type: Int, ptr: Int, len: Int): Int
+
+@WasmImport("env", "host_write_result")
+external fun host_write_result(ptr: Int, len: Int)
 
-@WasmImport("env", "host_write_result_byte")
-external fun host_write_result_byte(byte: Int)
+// 声明纯函数 action: 结果只取决于 action + json，Host 开启结果缓存后可直接复用结果
+@WasmImport("env", "host_declare_pure")
+external fun host_declare_pure(ptr: Int, len: Int)
 
 // --- 2. 内部桥接工具 ---
 internal object HostBridge {
@@ -30,18 +38,38 @@ internal object HostBridge {
         return readString(1, size)
     }
 
-    private fun readString(type: Int, size: Int): String {
-        val bytes = ByteArray(size)
-        for (i in 0 until size) {
-            bytes[i] = host_read_input_byte(type, i).toByte()
+    // 一次 Host 调用把整段输入拷进线性内存，再搬到 ByteArray
+    private fun readString(type: Int, size: Int): String = withScopedMemoryAllocator { allocator ->
+        val ptr = allocator.allocate(size)
+        val read = host_read_input(type, ptr.address.toInt(), size)
+        val bytes = ByteArray(read)
+        for (i in 0 until read) {
+            bytes[i] = (ptr + i).loadByte()
         }
-        return bytes.decodeToString()
+        bytes.decodeToString()
     }
 
     fun sendResult(result: String) {
         val bytes = result.encodeToByteArray()
-        for (b in bytes) {
-            host_write_result_byte(b.toInt())
+        if (bytes.isEmpty()) return
+        withScopedMemoryAllocator { allocator ->
+            val ptr = allocator.allocate(bytes.size)
+            for (i in bytes.indices) {
+                (ptr + i).storeByte(bytes[i])
+            }
+            host_write_result(ptr.address.toInt(), bytes.size)
+        }
+    }
+
+    fun declarePure(action: String) {
+        val bytes = action.encodeToByteArray()
+        if (bytes.isEmpty()) return
+        withScopedMemoryAllocator { allocator ->
+            val ptr = allocator.allocate(bytes.size)
+            for (i in bytes.indices) {
+                (ptr + i).storeByte(bytes[i])
+            }
+            host_declare_pure(ptr.address.toInt(), bytes.size)
         }
     }
 }
@@ -55,6 +83,12 @@ object WasmRouter {
         handlers[action] = handler
     }
 
+    // 注册纯函数路由 (无副作用，相同输入必然得到相同输出)，Host 开启结果缓存后重复请求不再进入 Wasm
+    fun registerPure(action: String, handler: (String) -> String) {
+        handlers[action] = handler
+        HostBridge.declarePure(action)
+    }
+
     // 内部调用
     internal fun dispatch(action: String, args: String): String {
         val handler = handlers[action]
@@ -1,16 +1,21 @@
-@file:OptIn(ExperimentalWasmInterop::class)
+@file:OptIn(ExperimentalWasmInterop::class, UnsafeWasmMemoryApi::class)
 
 package crow.wasmtime.wasmline
 
+import kotlin.wasm.unsafe.UnsafeWasmMemoryApi
+import kotlin.wasm.unsafe.withScopedMemoryAllocator
 import kotlinx.serialization.Serializable
 import kotlinx.serialization.json.Json
 
 @Serializable
 data class User(val id: Int, val name: String)
 
+@Serializable
+data class AllocRequest(val mb: Int)
+
 // 用户只需要在一个地方初始化路由
 fun initApp() {
-    WasmRouter.register("getUser") { jsonArgs ->
+    WasmRouter.registerPure("getUser") { jsonArgs ->
         // 纯粹的业务逻辑
         val user = User(1, "Crow Optimized")
         Json.encodeToString(user)
@@ -19,6 +24,19 @@ fun initApp() {
     WasmRouter.register("add") {
         "{\"result\": 999}"
     }
+
+    // 资源上限测试: 在线性内存中申请 mb 兆并逐页写入，超过 Store 上限时 memory.grow 失败，分配出错并以 Trap 或错误结果返回
+    WasmRouter.register("allocate") { jsonArgs ->
+        val request = Json.decodeFromString<AllocRequest>(jsonArgs)
+        val size = request.mb * 1024 * 1024
+        withScopedMemoryAllocator { allocator ->
+            val ptr = allocator.allocate(size)
+            for (offset in 0 until size step 65536) {
+                (ptr + offset).storeByte(1)
+            }
+        }
+        "{\"allocated\": ${request.mb}}"
+    }
 }
 
 @WasmExport